@@ -1,10 +1,139 @@
 #include "bits_button.h"
 #include "string.h"
 
-static bits_button_t bits_btn_entity;
-static bits_btn_debug_printf_func debug_printf = NULL;
+// Maximum number of history bits appended by a single press: press, long press, hold, release
+#define BITS_BTN_PRESS_MAX_BITS     4
+
+// Vector path for evaluating many combo masks at once; define BITS_BTN_DISABLE_SIMD to force the scalar path.
+#if !defined(BITS_BTN_DISABLE_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define BITS_BTN_SIMD_LANES         8
+#elif !defined(BITS_BTN_DISABLE_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BITS_BTN_SIMD_LANES         4
+#elif !defined(BITS_BTN_DISABLE_SIMD) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BITS_BTN_SIMD_LANES         4
+#endif
+
+// Storage of the engine state. With BITS_BTN_THREAD_LOCAL_ENGINE every thread gets its own,
+// independent engine instance; the engines share nothing and their events are not merged.
+#if defined(BITS_BTN_THREAD_LOCAL_ENGINE) && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define BITS_BTN_ENGINE_LOCAL       _Thread_local
+#elif defined(BITS_BTN_THREAD_LOCAL_ENGINE)
+#define BITS_BTN_ENGINE_LOCAL       __thread
+#else
+#define BITS_BTN_ENGINE_LOCAL
+#endif
+
+static BITS_BTN_ENGINE_LOCAL bits_button_t bits_btn_entity;
+static BITS_BTN_ENGINE_LOCAL bits_btn_debug_printf_func debug_printf = NULL;
+static BITS_BTN_ENGINE_LOCAL void *bits_btn_context = NULL;
+static BITS_BTN_ENGINE_LOCAL bits_btn_get_time_func bits_btn_time_func = NULL;
+static BITS_BTN_ENGINE_LOCAL uint32_t bits_btn_time_units_per_ms = 0;
+static BITS_BTN_ENGINE_LOCAL bits_btn_sequence_t *bits_btn_sequences = NULL;
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_sequences_cnt = 0;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_keymap_entry_t *bits_btn_keymap = NULL;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_dual_role_t *bits_btn_dual_roles = NULL;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_dual_roles_cnt = 0;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_priority_key_t *bits_btn_priority_keys = NULL;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_priority_keys_cnt = 0;
+static BITS_BTN_ENGINE_LOCAL bits_btn_result_callback bits_btn_priority_cb = NULL;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_keymap_layer_cnt = 0;
 static void debug_print_binary(key_value_type_t num);
 
+// ============================================================================
+// Runtime Configuration Queue
+// ============================================================================
+
+// Single producer (configuration API) / single consumer (bits_button_ticks) queue indices
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef atomic_uint_fast16_t bits_btn_config_index_t;
+#define BITS_BTN_CONFIG_LOAD(idx)           atomic_load_explicit(&(idx), memory_order_acquire)
+#define BITS_BTN_CONFIG_STORE(idx, value)   atomic_store_explicit(&(idx), (value), memory_order_release)
+#define BITS_BTN_CONFIG_FENCE()             atomic_thread_fence(memory_order_seq_cst)
+#else
+typedef volatile uint16_t bits_btn_config_index_t;
+#define BITS_BTN_CONFIG_LOAD(idx)           (idx)
+#define BITS_BTN_CONFIG_STORE(idx, value)   ((idx) = (value))
+// Without C11 atomics the snapshot sequence still needs a full barrier between the counter
+// and the data; other compilers only get the volatile accesses, enough on a single core.
+#if defined(__GNUC__) || defined(__clang__)
+#define BITS_BTN_CONFIG_FENCE()             __sync_synchronize()
+#else
+#define BITS_BTN_CONFIG_FENCE()             ((void)0)
+#endif
+#endif
+
+typedef enum {
+    BITS_BTN_CONFIG_ADD_COMBO,
+    BITS_BTN_CONFIG_REMOVE_COMBO,
+    BITS_BTN_CONFIG_SET_PARAM,
+    BITS_BTN_CONFIG_SET_ENABLED
+} bits_btn_config_op_type_t;
+
+// Changes name their target by key ID only and carry everything the tick writes, so the
+// producer never touches an object the tick may read; bits_button_ticks() resolves and applies them
+typedef struct
+{
+    uint8_t type;
+    uint8_t value;                          // Enabled flag for SET_ENABLED
+    uint16_t key_id;                        // Target single or combo button
+    button_obj_combo_t *combo;              // Combo for ADD_COMBO
+    button_mask_type_t combo_mask;          // Member mask of the combo for ADD_COMBO
+    const bits_btn_obj_param_t *param;      // New parameters for SET_PARAM
+} bits_btn_config_op_t;
+
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_op_t bits_btn_config_ops[BITS_BTN_CONFIG_QUEUE_SIZE];
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_config_read_idx;
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_config_write_idx;
+// Producer-side view of the combo list once every queued change is applied, so the
+// configuration API never reads the list the tick rewrites
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_config_combo_ids[BITS_BTN_MAX_COMBO_BUTTONS];
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_config_combo_cnt = 0;
+// Producer-side view of the compiled parameter table, which only the tick appends to
+static BITS_BTN_ENGINE_LOCAL const bits_btn_obj_param_t *bits_btn_config_params[BITS_BTN_MAX_PARAM_SETS];
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_config_params_cnt = 0;
+
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+// Deferred callbacks: single producer (bits_button_ticks) / single consumer (bits_button_process)
+static BITS_BTN_ENGINE_LOCAL bits_btn_deferred_event_t bits_btn_event_queue[BITS_BTN_EVENT_QUEUE_SIZE];
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_event_read_idx;
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_event_write_idx;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_deferred_callbacks = false;
+#endif
+
+#if BITS_BTN_BATCH_SIZE > 0
+// Events of the running tick, combo events in front of single button events
+static BITS_BTN_ENGINE_LOCAL bits_btn_batch_callback bits_btn_batch_cb = NULL;
+static BITS_BTN_ENGINE_LOCAL bits_btn_result_t bits_btn_batch[BITS_BTN_BATCH_SIZE];
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_batch_cnt = 0;
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_batch_combo_cnt = 0;
+#endif
+
+static BITS_BTN_ENGINE_LOCAL bits_btn_get_time_func bits_btn_cycle_counter = NULL;
+static BITS_BTN_ENGINE_LOCAL bits_btn_tick_stats_t bits_btn_tick_stats;    // Only written by the tick
+static BITS_BTN_ENGINE_LOCAL uint16_t bits_btn_tick_event_cnt = 0;      // Events reported by the running tick
+// Seqlock like the snapshot: odd while bits_button_ticks() is publishing the statistics
+static BITS_BTN_ENGINE_LOCAL bits_btn_tick_stats_t bits_btn_tick_stats_published;
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_tick_stats_seq;
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_tick_stats_reset;  // Set by bits_button_reset_tick_stats()
+
+#ifndef BITS_BTN_DISABLE_SNAPSHOT
+// Seqlock: odd while bits_button_ticks() is publishing the snapshot
+static BITS_BTN_ENGINE_LOCAL bits_btn_snapshot_t bits_btn_snapshot;
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_snapshot_seq;
+#endif
+
+// Pin-change notification, set from an ISR and cleared by bits_button_ticks()
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_change_pending;
+// Reset epochs: requested by bits_button_reset_states(), applied at the next tick boundary.
+// Events carry the applied epoch, readers drop the ones older than the requested epoch.
+static BITS_BTN_ENGINE_LOCAL bits_btn_config_index_t bits_btn_reset_epoch;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_applied_epoch = 0;
+static BITS_BTN_ENGINE_LOCAL uint8_t bits_btn_change_notification_enabled = false;
+
 // ============================================================================
 // Buffer Implementation Selection
 // ============================================================================
@@ -12,12 +141,12 @@ static void debug_print_binary(key_value_type_t num);
 #ifdef BITS_BTN_DISABLE_BUFFER
 
 // Disabled buffer mode - no buffer operations
-static const bits_btn_buffer_ops_t *bits_btn_buffer_ops = NULL;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_buffer_ops_t *bits_btn_buffer_ops = NULL;
 
 #elif defined(BITS_BTN_USE_USER_BUFFER)
 
 // User buffer mode - buffer operations set by user
-static const bits_btn_buffer_ops_t *bits_btn_buffer_ops = NULL;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_buffer_ops_t *bits_btn_buffer_ops = NULL;
 
 void bits_button_set_buffer_ops(const bits_btn_buffer_ops_t *user_buffer_ops)
 {
@@ -42,8 +171,8 @@ typedef struct
     atomic_size_t write_idx;  // Atomic write index
 } bits_btn_ring_buffer_t;
 
-static atomic_size_t overwrite_count = 0;
-static bits_btn_ring_buffer_t ring_buffer;
+static BITS_BTN_ENGINE_LOCAL atomic_size_t overwrite_count = 0;
+static BITS_BTN_ENGINE_LOCAL bits_btn_ring_buffer_t ring_buffer;
 
 
 /**
@@ -100,15 +229,16 @@ static size_t get_bits_btn_buffer_capacity_c11(void)
 }
 
 /**
-  * @brief  Clear the ring buffer. Note that additional synchronization is required in a multi-threaded environment.
+  * @brief  Clear the ring buffer from the consumer side: the read index jumps to the write
+  *         index, so the writer (bits_button_ticks) is never disturbed.
   * @retval None
   */
 static void bits_btn_clear_buffer_c11(void)
 {
     bits_btn_ring_buffer_t *buf = &ring_buffer;
 
-    atomic_store_explicit(&buf->read_idx, 0, memory_order_relaxed);
-    atomic_store_explicit(&buf->write_idx, 0, memory_order_relaxed);
+    size_t current_write = atomic_load_explicit(&buf->write_idx, memory_order_acquire);
+    atomic_store_explicit(&buf->read_idx, current_write, memory_order_release);
 }
 
 static size_t get_bits_btn_buffer_overwrite_count_c11(void)
@@ -189,17 +319,21 @@ static uint8_t bits_btn_read_buffer_c11(bits_btn_result_t *result)
 {
     bits_btn_ring_buffer_t *buf = &ring_buffer;
 
-    size_t current_write = atomic_load_explicit(&buf->write_idx, memory_order_acquire);
     size_t current_read = atomic_load_explicit(&buf->read_idx, memory_order_relaxed);
 
-    if (current_read == current_write) {  // Buffer is empty
-        return false;
-    }
+    // The producer also moves read_idx (overwrite, clear), so advance it with CAS
+    // instead of a plain store that could undo a concurrent clear
+    do {
+        size_t current_write = atomic_load_explicit(&buf->write_idx, memory_order_acquire);
 
-    *result = buf->buffer[current_read];
+        if (current_read == current_write) {  // Buffer is empty
+            return false;
+        }
 
-    // Update the read index (using modulo operation)
-    atomic_store_explicit(&buf->read_idx, (current_read + 1) % BITS_BTN_BUFFER_SIZE, memory_order_release);
+        *result = buf->buffer[current_read];
+    } while (!atomic_compare_exchange_weak_explicit(&buf->read_idx, &current_read,
+                                                    (current_read + 1) % BITS_BTN_BUFFER_SIZE,
+                                                    memory_order_release, memory_order_relaxed));
 
     return true;
 }
@@ -225,6 +359,72 @@ static uint8_t bits_btn_peek_buffer_c11(bits_btn_result_t *result)
     return true;
 }
 
+/**
+  * @brief  Map the readable part of the ring buffer as at most two contiguous segments.
+  * @param  view: View to fill.
+  * @retval true if the view holds events, false if the buffer is empty.
+  */
+static uint8_t bits_btn_acquire_view_c11(bits_btn_buffer_view_t *view)
+{
+    bits_btn_ring_buffer_t *buf = &ring_buffer;
+
+    size_t current_write = atomic_load_explicit(&buf->write_idx, memory_order_acquire);
+    size_t current_read = atomic_load_explicit(&buf->read_idx, memory_order_relaxed);
+
+    memset(view, 0, sizeof(*view));
+    view->read_idx = current_read;
+    view->overwrite_count = atomic_load_explicit(&overwrite_count, memory_order_relaxed);
+
+    if (current_read == current_write) {  // Buffer is empty
+        return false;
+    }
+
+    view->first = &buf->buffer[current_read];
+    if (current_read < current_write) {
+        view->first_len = current_write - current_read;
+    } else {
+        view->first_len = BITS_BTN_BUFFER_SIZE - current_read;
+        if (current_write > 0) {
+            view->second = &buf->buffer[0];
+            view->second_len = current_write;
+        }
+    }
+
+    return true;
+}
+
+/**
+  * @brief  Consume the events of a view by moving the read index once past them.
+  * @param  view: View filled by bits_btn_acquire_view_c11().
+  * @retval true if no event was overwritten while the view was held.
+  */
+static uint8_t bits_btn_release_view_c11(const bits_btn_buffer_view_t *view)
+{
+    bits_btn_ring_buffer_t *buf = &ring_buffer;
+
+    size_t count = view->first_len + view->second_len;
+    size_t end_read = (view->read_idx + count) % BITS_BTN_BUFFER_SIZE;
+    size_t current_read = view->read_idx;
+
+    if (count == 0) {
+        return true;
+    }
+
+    // The writer advances the read index itself when the buffer is full; only move it forward
+    // while it is still inside the view, never back over events written after it.
+    while (!atomic_compare_exchange_weak_explicit(&buf->read_idx, &current_read, end_read,
+                                                  memory_order_release, memory_order_relaxed))
+    {
+        size_t advanced = (current_read + BITS_BTN_BUFFER_SIZE - view->read_idx) % BITS_BTN_BUFFER_SIZE;
+
+        if (advanced > count) {
+            break;
+        }
+    }
+
+    return atomic_load_explicit(&overwrite_count, memory_order_relaxed) == view->overwrite_count;
+}
+
 const bits_btn_buffer_ops_t c11_buffer_ops = {
     .init = bits_btn_init_buffer_c11,
     .write = bits_btn_write_buffer_overwrite_c11,
@@ -238,12 +438,14 @@ const bits_btn_buffer_ops_t c11_buffer_ops = {
     .peek = bits_btn_peek_buffer_c11,  // Add peek function to the structure
 };
 
-static const bits_btn_buffer_ops_t *bits_btn_buffer_ops = &c11_buffer_ops;
+static BITS_BTN_ENGINE_LOCAL const bits_btn_buffer_ops_t *bits_btn_buffer_ops = &c11_buffer_ops;
 
 #endif
 
 #ifndef BITS_BTN_DISABLE_BUFFER
-static bits_btn_result_user_filter_callback bits_btn_result_user_filter_cb = NULL;
+static BITS_BTN_ENGINE_LOCAL bits_btn_result_user_filter_callback bits_btn_result_user_filter_cb = NULL;
+static BITS_BTN_ENGINE_LOCAL uint32_t bits_btn_filter_event_mask = BITS_BTN_DEFAULT_EVENT_MASK;
+static BITS_BTN_ENGINE_LOCAL button_mask_type_t bits_btn_filter_key_mask = ~(button_mask_type_t)0;
 
 void bits_btn_register_result_filter_callback(bits_btn_result_user_filter_callback cb)
 {
@@ -252,6 +454,12 @@ void bits_btn_register_result_filter_callback(bits_btn_result_user_filter_callba
         bits_btn_result_user_filter_cb = cb;
     }
 }
+
+void bits_btn_set_result_filter_mask(uint32_t event_mask, button_mask_type_t key_mask)
+{
+    bits_btn_filter_event_mask = event_mask;
+    bits_btn_filter_key_mask = key_mask;
+}
 #endif
 
 /**
@@ -282,10 +490,262 @@ static uint32_t get_button_tick(void)
     return bits_btn_entity.btn_tick;
 }
 
+/**
+  * @brief  Check whether a deadline has been reached, safe across tick counter wrap-around.
+  * @param  now: Current time.
+  * @param  deadline: Absolute deadline.
+  * @retval 1 if the deadline is reached, 0 otherwise.
+  */
+static uint8_t __is_deadline_reached(uint32_t now, uint32_t deadline)
+{
+    return (int32_t)(now - deadline) >= 0;
+}
+
+/**
+  * @brief  Get the index of the lowest set bit of a non-zero mask.
+  * @param  mask: Button mask, must not be zero.
+  * @retval Bit index.
+  */
+static uint8_t __lowest_bit_index(button_mask_type_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_ctzl((unsigned long)mask);
+#else
+    uint8_t index = 0;
+    while ((mask & 1U) == 0)
+    {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+  * @brief  Count the set bits of a button mask.
+  * @param  mask: Button mask.
+  * @retval Number of set bits.
+  */
+static uint8_t __count_bits(button_mask_type_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_popcountl((unsigned long)mask);
+#else
+    uint8_t count = 0;
+    while (mask)
+    {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+  * @brief  Convert a duration in milliseconds to engine time units, rounding down.
+  * @param  ms: Duration in milliseconds.
+  * @retval Duration in engine time units.
+  */
+static uint32_t __ms_to_time(uint32_t ms)
+{
+    if (bits_btn_time_func != NULL)
+        return ms * bits_btn_time_units_per_ms;
+
+    return ms / BITS_BTN_TICKS_INTERVAL;
+}
+
+/**
+  * @brief  Convert a state timeout in milliseconds to engine time units.
+  *         A state times out once more than `ms` milliseconds have elapsed since it was entered.
+  * @param  ms: Timeout in milliseconds.
+  * @retval Time after state entry at which the state expires.
+  */
+static uint32_t __ms_to_expire_time(uint32_t ms)
+{
+    return __ms_to_time(ms) + 1;
+}
+
+/**
+  * @brief  Convert a minimum duration in milliseconds to engine time units, rounding up.
+  * @param  ms: Duration in milliseconds.
+  * @retval Duration in engine time units.
+  */
+static uint32_t __ms_to_min_time(uint32_t ms)
+{
+    if (bits_btn_time_func != NULL)
+        return ms * bits_btn_time_units_per_ms;
+
+    return (ms + BITS_BTN_TICKS_INTERVAL - 1) / BITS_BTN_TICKS_INTERVAL;
+}
+
+void bits_button_set_time_source(bits_btn_get_time_func time_func, uint32_t time_units_per_ms)
+{
+    if (time_func != NULL && time_units_per_ms == 0)
+        return;
+
+    bits_btn_time_func = time_func;
+    bits_btn_time_units_per_ms = time_units_per_ms;
+}
+
+void bits_button_set_keymap(const bits_btn_keymap_entry_t *keymap, uint8_t layer_cnt)
+{
+    bits_btn_keymap = (layer_cnt > 0) ? keymap : NULL;
+    bits_btn_keymap_layer_cnt = (keymap != NULL) ? layer_cnt : 0;
+}
+
+void bits_button_set_dual_roles(const bits_btn_dual_role_t *dual_roles, uint8_t dual_roles_cnt)
+{
+    bits_btn_dual_roles = dual_roles;
+    bits_btn_dual_roles_cnt = (dual_roles != NULL) ? dual_roles_cnt : 0;
+}
+
+void bits_button_set_priority_keys(const bits_btn_priority_key_t *priority_keys, uint8_t priority_keys_cnt,
+                                   bits_btn_result_callback fast_cb)
+{
+    bits_btn_priority_keys = priority_keys;
+    bits_btn_priority_keys_cnt = (priority_keys != NULL) ? priority_keys_cnt : 0;
+    bits_btn_priority_cb = fast_cb;
+}
+
+void bits_button_set_layer(uint8_t layer)
+{
+    if (layer < bits_btn_entity.layer_cnt)
+        bits_btn_entity.base_layer = layer;
+}
+
+uint8_t bits_button_get_layer(void)
+{
+    bits_button_t *button = &bits_btn_entity;
+
+    return (button->momentary_layer != BITS_BTN_NO_LAYER) ? button->momentary_layer : button->base_layer;
+}
+
+void bits_button_set_sequences(bits_btn_sequence_t *sequences, uint16_t sequences_cnt)
+{
+    bits_btn_sequences = sequences;
+    bits_btn_sequences_cnt = (sequences != NULL) ? sequences_cnt : 0;
+}
+
+/**
+  * @brief  Get the hold period that follows a given number of hold events.
+  *         Without acceleration this is always the configured period, otherwise it shrinks by
+  *         one step per event until it reaches the minimum period.
+  * @param  param: Compiled parameter set of the button.
+  * @param  trigger_cnt: Number of hold events reported so far.
+  * @retval Hold period in engine time units.
+  */
+static uint32_t __get_hold_period(const bits_btn_compiled_param_t *param, uint16_t trigger_cnt)
+{
+    uint32_t span = param->long_press_period_time - param->long_press_period_min_time;
+
+    if (param->long_press_period_step_time == 0 || trigger_cnt >= span / param->long_press_period_step_time)
+        return param->long_press_period_min_time;
+
+    return param->long_press_period_time - trigger_cnt * param->long_press_period_step_time;
+}
+
+/**
+  * @brief  Find or add the compiled (tick domain) copy of a button parameter set.
+  * @param  button: Pointer to the bits button object.
+  * @param  param: Parameter set to compile, may be NULL.
+  * @retval Index in the compiled parameter table, BITS_BTN_INVALID_PARAM_INDEX if `param` is NULL
+  *         or the table is full.
+  */
+static uint8_t __compile_param(bits_button_t *button, const bits_btn_obj_param_t *param)
+{
+    if (param == NULL)
+        return BITS_BTN_INVALID_PARAM_INDEX;
+
+    for (uint8_t i = 0; i < button->compiled_params_cnt; i++)
+    {
+        if (button->compiled_params[i].param == param)
+            return i;
+    }
+
+    if (button->compiled_params_cnt >= BITS_BTN_MAX_PARAM_SETS)
+        return BITS_BTN_INVALID_PARAM_INDEX;
+
+    bits_btn_compiled_param_t *compiled = &button->compiled_params[button->compiled_params_cnt];
+    compiled->param = param;
+    compiled->long_press_start_time = __ms_to_expire_time(param->long_press_start_time_ms);
+    compiled->long_press_period_time = __ms_to_expire_time(param->long_press_period_triger_ms);
+    compiled->long_press_period_min_time = compiled->long_press_period_time;
+    compiled->long_press_period_step_time = 0;
+    if (param->long_press_period_min_ms != 0 && param->long_press_period_step_ms != 0 &&
+        param->long_press_period_min_ms < param->long_press_period_triger_ms)
+    {
+        compiled->long_press_period_min_time = __ms_to_expire_time(param->long_press_period_min_ms);
+        compiled->long_press_period_step_time = __ms_to_time(param->long_press_period_step_ms);
+        if (compiled->long_press_period_step_time == 0)
+            compiled->long_press_period_step_time = 1;
+    }
+    // The release window is armed when the release is detected. Counting ticks, the window keeps
+    // the extra tick that reports the release; with a time source it runs from the release itself.
+    compiled->time_window_time = __ms_to_expire_time(param->time_window_time_ms);
+    if (bits_btn_time_func == NULL)
+        compiled->time_window_time++;
+
+    return button->compiled_params_cnt++;
+}
+
+/**
+  * @brief  Assign a compiled parameter slot to a button object.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn: Button object to set up.
+  * @retval 0 on success, -1 if the compiled parameter table is full.
+  */
+static int32_t __bind_button_param(bits_button_t *button, button_obj_t *btn)
+{
+    btn->param_index = __compile_param(button, btn->param);
+
+    if (btn->param != NULL && btn->param_index == BITS_BTN_INVALID_PARAM_INDEX)
+        return -1;
+
+    return 0;
+}
+
+/**
+  * @brief  Check whether bits_button_init() has set up the engine of the calling context.
+  *         With BITS_BTN_THREAD_LOCAL_ENGINE every thread has its own engine, so a thread
+  *         that never called bits_button_init() sees an empty one.
+  * @retval true if the engine is initialized.
+  */
+static uint8_t __engine_ready(void)
+{
+    return bits_btn_entity.btns != NULL;
+}
+
+/**
+  * @brief  Check whether a result was reported before the last bits_button_reset_states().
+  * @param  result: Pointer to the result.
+  * @retval true if the result belongs to the state before the reset.
+  */
+static uint8_t __is_stale_result(const bits_btn_result_t *result)
+{
+    return result->reset_epoch != (uint8_t)BITS_BTN_CONFIG_LOAD(bits_btn_reset_epoch);
+}
+
+/**
+  * @brief  Consume the buffered results reported before the last reset. Consumer side, like
+  *         the other buffer reads; stale results are always the oldest ones.
+  * @retval None
+  */
+static void __drop_stale_results(void)
+{
+    bits_btn_result_t result;
+
+    if (bits_btn_buffer_ops == NULL || bits_btn_buffer_ops->peek == NULL || bits_btn_buffer_ops->read == NULL)
+        return;
+
+    while (bits_btn_buffer_ops->peek(&result) && __is_stale_result(&result))
+        bits_btn_buffer_ops->read(&result);
+}
+
 uint8_t bits_btn_is_buffer_empty(void)
 {
     if (bits_btn_buffer_ops && bits_btn_buffer_ops->is_empty)
     {
+        __drop_stale_results();
         return bits_btn_buffer_ops->is_empty();
     }
     return true;
@@ -304,13 +764,15 @@ size_t get_bits_btn_buffer_used_count(void)
 {
     if (bits_btn_buffer_ops && bits_btn_buffer_ops->get_buffer_used_count)
     {
+        __drop_stale_results();
         return bits_btn_buffer_ops->get_buffer_used_count();
     }
     return 0;
 }
 
 /**
-  * @brief  Clear the ring buffer. Note that additional synchronization is required in a multi-threaded environment.
+  * @brief  Clear the ring buffer. This is a consumer-side operation, call it from the
+  *         context that reads the results.
   * @retval None
   */
 void bits_btn_clear_buffer(void)
@@ -339,53 +801,59 @@ size_t get_bits_btn_buffer_capacity(void)
     return 0;
 }
 
+/**
+  * @brief  Insert a combo button into the priority ordered combo list.
+  * @param  button: Pointer to button object
+  * @param  combo: Combo button with its combo_mask already resolved
+  * @retval None
+  */
+static void __insert_sorted_combo(bits_button_t *button, button_obj_combo_t *combo)
+{
+    uint16_t pos = button->btns_combo_cnt;
+
+    // Higher key count has higher priority, equal key counts keep their insertion order
+    while (pos > 0 && button->combo_sorted[pos - 1]->key_count < combo->key_count)
+    {
+        // Shift lower priority elements backward
+        button->combo_sorted[pos] = button->combo_sorted[pos - 1];
+        button->combo_masks[pos] = button->combo_masks[pos - 1];
+        pos--;
+    }
+
+    button->combo_sorted[pos] = combo;
+    button->combo_masks[pos] = combo->combo_mask;
+    button->btns_combo_cnt++;
+}
+
 /**
   * @brief  Sort combo buttons during initialization (descending by key count)
   * @param  button: Pointer to button object
+  * @param  btns_combo: Combo buttons passed to bits_button_init()
+  * @param  cnt: Number of combo buttons
   * @retval None
   */
- static void sort_combo_buttons_in_init(bits_button_t *button)
+ static void sort_combo_buttons_in_init(bits_button_t *button, button_obj_combo_t *btns_combo, uint16_t cnt)
  {
-    const uint16_t cnt = button->btns_combo_cnt;  // Get number of combo buttons
+    button->btns_combo_cnt = 0;
 
-    // Skip sorting if no combo buttons or only one
-    if (cnt <= 1)
+    if (cnt == 0)
     {
-        if (debug_printf && cnt == 0) debug_printf("No combo buttons\n");
+        if (debug_printf) debug_printf("No combo buttons\n");
         return;
     }
 
-    // Initialize index array (0,1,2,...)
-    for (uint16_t i = 0; i < cnt; i++)
-        button->combo_sorted_indices[i] = i;
-
     // Insertion sort (descending by key count)
-    for (uint16_t i = 1; i < cnt; i++)
-    {
-        const uint16_t temp_idx = button->combo_sorted_indices[i];  // Current element to insert
-        const uint8_t temp_keys = button->btns_combo[temp_idx].key_count;  // Key count of current element
-        int16_t j = i - 1;  // Start from end of sorted portion
-
-        // Find insertion position: higher key count has higher priority
-        while (j >= 0 &&
-               button->btns_combo[button->combo_sorted_indices[j]].key_count < temp_keys)
-        {
-            // Shift lower priority elements backward
-            button->combo_sorted_indices[j + 1] = button->combo_sorted_indices[j];
-            j--;
-        }
-        // Insert current element at correct position
-        button->combo_sorted_indices[j + 1] = temp_idx;
-    }
+    for (uint16_t i = 0; i < cnt; i++)
+        __insert_sorted_combo(button, &btns_combo[i]);
 
 #if 0
     // Debug output of sorting results
     if (debug_printf)
     {
-        debug_printf("Sorted combo indices (%d):\n", cnt);
+        debug_printf("Sorted combos (%d):\n", cnt);
         for (uint16_t i = 0; i < cnt; i++)
         {
-            const button_obj_combo_t* c = &button->btns_combo[button->combo_sorted_indices[i]];
+            const button_obj_combo_t* c = button->combo_sorted[i];
             debug_printf("  %d: ID=%d, Keys=", i, c->btn.key_id);
             for (uint8_t j = 0; j < c->key_count; j++)
                 debug_printf("%d ", c->key_single_ids[j]);
@@ -395,68 +863,440 @@ size_t get_bits_btn_buffer_capacity(void)
 #endif
 }
 
-int32_t bits_button_init(button_obj_t* btns                                     , \
-                         uint16_t btns_cnt                                      , \
-                         button_obj_combo_t *btns_combo                         , \
-                         uint16_t btns_combo_cnt                                , \
-                         bits_btn_read_button_level read_button_level_func      , \
-                         bits_btn_result_callback bits_btn_result_cb            , \
-                         bits_btn_debug_printf_func bis_btn_debug_printf          \
-                 )
+/**
+  * @brief  Validate the keymap and compile the parameters of every entry.
+  * @param  button: Pointer to the bits button object.
+  * @retval 0 on success, -8 if the keymap is invalid, -5 if the parameter table is full.
+  */
+static int32_t __compile_keymap(bits_button_t *button)
 {
-    bits_button_t *button = &bits_btn_entity;
-    debug_printf = bis_btn_debug_printf;
-
-    if (btns == NULL || read_button_level_func == NULL ||
-        (btns_combo_cnt > 0 && btns_combo == NULL))
-    {
-        if(debug_printf)
-            debug_printf("Invalid init parameters !\n");
-        return -2;
-    }
+    button->momentary_layer = BITS_BTN_NO_LAYER;
 
-    memset(button, 0, sizeof(bits_button_t));
+    if (bits_btn_keymap == NULL)
+        return 0;
 
-    button->btns = btns;
-    button->btns_cnt = btns_cnt;
-    button->btns_combo = btns_combo;
-    button->btns_combo_cnt = btns_combo_cnt;
-    button->_read_button_level = read_button_level_func;
-    button->bits_btn_result_cb = bits_btn_result_cb;
+    if (bits_btn_keymap_layer_cnt > BITS_BTN_MAX_LAYERS || button->btns_cnt > BITS_BTN_MAX_KEYS)
+        return -8;
 
-    if (btns_combo_cnt > BITS_BTN_MAX_COMBO_BUTTONS)
+    for (uint16_t i = 0; i < bits_btn_keymap_layer_cnt * button->btns_cnt; i++)
     {
-        if (debug_printf)
-        {
-            debug_printf("Error: Too many combo buttons (%d > max %d)\n",
-                         btns_combo_cnt, BITS_BTN_MAX_COMBO_BUTTONS);
-        }
-        return -3;
-    }
+        const bits_btn_keymap_entry_t *entry = &bits_btn_keymap[i];
 
-    for(uint16_t i = 0; i < btns_combo_cnt; i++)
-    {
-        button_obj_combo_t *combo = &button->btns_combo[i];
-        combo->combo_mask = 0;
+        if (entry->action != BITS_BTN_ACTION_NONE && entry->action_layer >= bits_btn_keymap_layer_cnt)
+            return -8;
 
-        for(uint16_t j = 0; j < combo->key_count; j++)
+        if (entry->param == NULL)
         {
-            int idx = _get_btn_index_by_key_id(combo->key_single_ids[j]);
-            if (idx == -1)
-            {
-                if(debug_printf)
-                    debug_printf("Error, get_btn_index failed! \n");
-                return -1; // Invalid ID
-            }
-            combo->combo_mask |= ((button_mask_type_t)1UL << idx);
+            button->keymap_param_index[i] = button->btns[i % button->btns_cnt].param_index;
+            continue;
         }
+
+        button->keymap_param_index[i] = __compile_param(button, entry->param);
+        if (button->keymap_param_index[i] == BITS_BTN_INVALID_PARAM_INDEX)
+            return -5;
     }
 
-    // Sort the combination buttons during initialization.
-    sort_combo_buttons_in_init(button);
+    button->layer_cnt = bits_btn_keymap_layer_cnt;
 
-#ifdef BITS_BTN_USE_USER_BUFFER
-    if (bits_btn_buffer_ops == NULL)
+    return 0;
+}
+
+/**
+  * @brief  Map the dual-role keys to button indices and convert their hold times.
+  * @param  button: Pointer to the bits button object.
+  * @retval 0 on success, -9 if a dual-role key is invalid.
+  */
+static int32_t __compile_dual_roles(bits_button_t *button)
+{
+    if (bits_btn_dual_roles_cnt == 0)
+        return 0;
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    if (bits_btn_dual_roles_cnt > BITS_BTN_MAX_DUAL_ROLE_KEYS)
+        return -9;
+
+    for (uint8_t i = 0; i < bits_btn_dual_roles_cnt; i++)
+    {
+        int idx = _get_btn_index_by_key_id(bits_btn_dual_roles[i].key_id);
+        button_mask_type_t btn_mask;
+
+        if (idx < 0 || idx >= BITS_BTN_MAX_KEYS)
+            return -9;
+
+        btn_mask = (button_mask_type_t)1UL << idx;
+        if (button->dual_role_mask & btn_mask)
+            return -9;
+
+        button->dual_role_mask |= btn_mask;
+        button->dual_role_btn_index[i] = (uint8_t)idx;
+        button->dual_role_hold_time[i] = __ms_to_min_time(bits_btn_dual_roles[i].hold_time_ms);
+    }
+
+    button->dual_role_cnt = bits_btn_dual_roles_cnt;
+
+    return 0;
+#else
+    (void)button;
+    return -9;
+#endif
+}
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+/**
+  * @brief  Check whether a priority key is a member of a combo, sequence or dual-role key.
+  *         Priority keys bypass the engine that evaluates those, so they would never match.
+  * @param  button: Pointer to the bits button object, with combo masks and dual-role keys set.
+  * @retval true if a priority key is used elsewhere.
+  */
+static uint8_t __priority_keys_shared(bits_button_t *button)
+{
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    if (button->dual_role_mask & button->priority_mask)
+        return true;
+#endif
+
+    for (uint16_t i = 0; i < button->btns_combo_cnt; i++)
+    {
+        if (button->btns_combo[i].combo_mask & button->priority_mask)
+            return true;
+    }
+
+    for (uint16_t i = 0; i < bits_btn_sequences_cnt; i++)
+    {
+        const bits_btn_sequence_t *seq = &bits_btn_sequences[i];
+
+        for (uint8_t j = 0; seq->key_single_ids != NULL && j < seq->key_count; j++)
+        {
+            int idx = _get_btn_index_by_key_id(seq->key_single_ids[j]);
+
+            if (idx >= 0 && idx < BITS_BTN_MAX_KEYS &&
+                (button->priority_mask & ((button_mask_type_t)1UL << idx)))
+                return true;
+        }
+    }
+
+    return false;
+}
+#endif
+
+/**
+  * @brief  Map the priority keys to button indices and convert their debounce times.
+  * @param  button: Pointer to the bits button object.
+  * @retval 0 on success, -10 if a priority key is invalid or a member of a combo,
+  *         sequence or dual-role key.
+  */
+static int32_t __compile_priority_keys(bits_button_t *button)
+{
+    if (bits_btn_priority_keys_cnt == 0)
+        return 0;
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    if (bits_btn_priority_keys_cnt > BITS_BTN_MAX_PRIORITY_KEYS)
+        return -10;
+
+    for (uint8_t i = 0; i < bits_btn_priority_keys_cnt; i++)
+    {
+        int idx = _get_btn_index_by_key_id(bits_btn_priority_keys[i].key_id);
+        button_mask_type_t btn_mask;
+
+        if (idx < 0 || idx >= BITS_BTN_MAX_KEYS)
+            return -10;
+
+        btn_mask = (button_mask_type_t)1UL << idx;
+        if (button->priority_mask & btn_mask)
+            return -10;
+
+        button->priority_mask |= btn_mask;
+        button->priority_btn_index[i] = (uint8_t)idx;
+        button->priority_press_time[i] = __ms_to_min_time(bits_btn_priority_keys[i].press_debounce_ms);
+        button->priority_release_time[i] = __ms_to_min_time(bits_btn_priority_keys[i].release_debounce_ms);
+    }
+
+    if (__priority_keys_shared(button))
+        return -10;
+
+    button->priority_cnt = bits_btn_priority_keys_cnt;
+    button->priority_cb = (bits_btn_priority_cb != NULL) ? bits_btn_priority_cb : button->bits_btn_result_cb;
+
+    return 0;
+#else
+    (void)button;
+    return -10;
+#endif
+}
+
+/**
+  * @brief  Check whether a sequence starts with the first `depth` keys of another one.
+  * @param  seq: Sequence to check.
+  * @param  prefix: Sequence providing the prefix.
+  * @param  depth: Prefix length.
+  * @retval true if the prefix matches.
+  */
+static uint8_t __sequence_has_prefix(const bits_btn_sequence_t *seq, const bits_btn_sequence_t *prefix, uint8_t depth)
+{
+    if (seq->key_count < depth)
+        return false;
+
+    for (uint8_t i = 0; i < depth; i++)
+    {
+        if (seq->key_single_ids[i] != prefix->key_single_ids[i])
+            return false;
+    }
+
+    return true;
+}
+
+/**
+  * @brief  Build the sequence trie breadth first, so the children of every node are
+  *         contiguous and ordered by button index.
+  * @param  button: Pointer to the bits button object.
+  * @retval 0 on success, -1 if a sequence is invalid or the trie does not fit.
+  */
+static int32_t __build_sequence_trie(bits_button_t *button)
+{
+    uint8_t node_depth[BITS_BTN_MAX_SEQUENCE_NODES];
+    uint8_t node_seq[BITS_BTN_MAX_SEQUENCE_NODES];     // A sequence passing through each node
+
+    if (bits_btn_sequences_cnt == 0)
+        return 0;
+
+    for (uint16_t i = 0; i < bits_btn_sequences_cnt; i++)
+    {
+        const bits_btn_sequence_t *seq = &bits_btn_sequences[i];
+
+        if (seq->key_count == 0 || seq->key_single_ids == NULL || i >= BITS_BTN_SEQ_NO_MATCH)
+            return -1;
+
+        for (uint8_t j = 0; j < seq->key_count; j++)
+        {
+            if (_get_btn_index_by_key_id(seq->key_single_ids[j]) == -1)
+                return -1;
+        }
+    }
+
+    node_depth[0] = 0;
+    node_seq[0] = 0;
+    button->seq_nodes_cnt = 1;
+
+    for (uint8_t n = 0; n < button->seq_nodes_cnt; n++)
+    {
+        bits_btn_seq_node_t *node = &button->seq_nodes[n];
+        const bits_btn_sequence_t *prefix = &bits_btn_sequences[node_seq[n]];
+        uint8_t depth = node_depth[n];
+        uint16_t timeout_ms = 0;
+
+        node->child_mask = 0;
+        node->match = BITS_BTN_SEQ_NO_MATCH;
+
+        for (uint16_t i = 0; i < bits_btn_sequences_cnt; i++)
+        {
+            const bits_btn_sequence_t *seq = &bits_btn_sequences[i];
+
+            if (!__sequence_has_prefix(seq, prefix, depth))
+                continue;
+
+            if (seq->key_count == depth)
+            {
+                if (node->match == BITS_BTN_SEQ_NO_MATCH)
+                    node->match = (uint8_t)i;
+                continue;
+            }
+
+            node->child_mask |= (button_mask_type_t)1UL << _get_btn_index_by_key_id(seq->key_single_ids[depth]);
+            if (seq->timeout_ms > timeout_ms)
+                timeout_ms = seq->timeout_ms;
+        }
+
+        node->timeout_time = __ms_to_expire_time(timeout_ms);
+        node->first_child = button->seq_nodes_cnt;
+
+        button_mask_type_t pending_mask = node->child_mask;
+        while (pending_mask)
+        {
+            uint8_t btn_index = __lowest_bit_index(pending_mask);
+            pending_mask &= pending_mask - 1;
+
+            if (button->seq_nodes_cnt >= BITS_BTN_MAX_SEQUENCE_NODES)
+                return -1;
+
+            for (uint16_t i = 0; i < bits_btn_sequences_cnt; i++)
+            {
+                const bits_btn_sequence_t *seq = &bits_btn_sequences[i];
+
+                if (seq->key_count > depth && __sequence_has_prefix(seq, prefix, depth) &&
+                    _get_btn_index_by_key_id(seq->key_single_ids[depth]) == btn_index)
+                {
+                    node_seq[button->seq_nodes_cnt] = (uint8_t)i;
+                    break;
+                }
+            }
+
+            node_depth[button->seq_nodes_cnt] = depth + 1;
+            button->seq_nodes_cnt++;
+        }
+    }
+
+    return 0;
+}
+
+int32_t bits_button_init(button_obj_t* btns                                     , \
+                         uint16_t btns_cnt                                      , \
+                         button_obj_combo_t *btns_combo                         , \
+                         uint16_t btns_combo_cnt                                , \
+                         bits_btn_read_button_level read_button_level_func      , \
+                         bits_btn_result_callback bits_btn_result_cb            , \
+                         bits_btn_debug_printf_func bis_btn_debug_printf          \
+                 )
+{
+    bits_button_t *button = &bits_btn_entity;
+    debug_printf = bis_btn_debug_printf;
+
+    if (btns == NULL || read_button_level_func == NULL ||
+        (btns_combo_cnt > 0 && btns_combo == NULL))
+    {
+        if(debug_printf)
+            debug_printf("Invalid init parameters !\n");
+        return -2;
+    }
+
+    memset(button, 0, sizeof(bits_button_t));
+
+    button->btns = btns;
+    button->btns_cnt = btns_cnt;
+    button->btns_combo = btns_combo;
+    button->btns_combo_cnt = btns_combo_cnt;
+    button->_read_button_level = read_button_level_func;
+    button->bits_btn_result_cb = bits_btn_result_cb;
+    button->press_debounce_time = __ms_to_min_time(BITS_BTN_PRESS_DEBOUNCE_TIME_MS);
+    button->release_debounce_time = __ms_to_min_time(BITS_BTN_RELEASE_DEBOUNCE_TIME_MS);
+    button->enabled_mask = ~(button_mask_type_t)0;
+    if (bits_btn_time_func != NULL)
+        button->btn_tick = bits_btn_time_func();
+    button->debounce_deadline = button->btn_tick;
+
+    BITS_BTN_CONFIG_STORE(bits_btn_config_read_idx, 0);
+    BITS_BTN_CONFIG_STORE(bits_btn_config_write_idx, 0);
+    BITS_BTN_CONFIG_STORE(bits_btn_change_pending, 1);
+    bits_btn_applied_epoch = (uint8_t)BITS_BTN_CONFIG_LOAD(bits_btn_reset_epoch);
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    BITS_BTN_CONFIG_STORE(bits_btn_event_read_idx, 0);
+    BITS_BTN_CONFIG_STORE(bits_btn_event_write_idx, 0);
+#endif
+    bits_btn_config_combo_cnt = 0;
+    bits_btn_config_params_cnt = 0;
+
+    if (btns_combo_cnt > BITS_BTN_MAX_COMBO_BUTTONS)
+    {
+        if (debug_printf)
+        {
+            debug_printf("Error: Too many combo buttons (%d > max %d)\n",
+                         btns_combo_cnt, BITS_BTN_MAX_COMBO_BUTTONS);
+        }
+        return -3;
+    }
+
+    if (btns_cnt > BITS_BTN_MAX_KEYS)
+    {
+        if (debug_printf)
+        {
+            debug_printf("Error: Too many buttons (%d > max %d)\n",
+                         btns_cnt, BITS_BTN_MAX_KEYS);
+        }
+        return -11;
+    }
+
+    for(uint16_t i = 0; i < btns_combo_cnt; i++)
+    {
+        button_obj_combo_t *combo = &button->btns_combo[i];
+        combo->combo_mask = 0;
+        bits_btn_config_combo_ids[i] = combo->btn.key_id;
+
+        for(uint16_t j = 0; j < combo->key_count; j++)
+        {
+            int idx = _get_btn_index_by_key_id(combo->key_single_ids[j]);
+            if (idx == -1)
+            {
+                if(debug_printf)
+                    debug_printf("Error, get_btn_index failed! \n");
+                return -1; // Invalid ID
+            }
+            combo->combo_mask |= ((button_mask_type_t)1UL << idx);
+        }
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+        if (combo->suppress)
+            button->combo_member_mask |= combo->combo_mask;
+#endif
+    }
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    button->combo_term_time = __ms_to_min_time(BITS_BTN_COMBO_TERM_MS);
+#endif
+
+    // Convert every parameter set to ticks once, so the state machines only compare deadlines.
+    for (uint16_t i = 0; i < btns_cnt; i++)
+    {
+        if (__bind_button_param(button, &btns[i]) != 0)
+        {
+            if (debug_printf)
+                debug_printf("Error: Too many parameter sets (max %d)\n", BITS_BTN_MAX_PARAM_SETS);
+            return -5;
+        }
+    }
+
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+    for (uint16_t i = 0; i < btns_cnt && i < BITS_BTN_MAX_KEYS; i++)
+    {
+        if (btns[i].eager_debounce)
+            button->eager_mask |= (button_mask_type_t)1UL << i;
+    }
+#endif
+
+    for (uint16_t i = 0; i < btns_combo_cnt; i++)
+    {
+        if (__bind_button_param(button, &btns_combo[i].btn) != 0)
+        {
+            if (debug_printf)
+                debug_printf("Error: Too many parameter sets (max %d)\n", BITS_BTN_MAX_PARAM_SETS);
+            return -5;
+        }
+    }
+
+    // Sort the combination buttons during initialization.
+    sort_combo_buttons_in_init(button, btns_combo, btns_combo_cnt);
+
+    int32_t keymap_ret = __compile_keymap(button);
+    if (keymap_ret != 0)
+    {
+        if (debug_printf)
+            debug_printf("Error: Invalid keymap (max %d layers)\n", BITS_BTN_MAX_LAYERS);
+        return keymap_ret;
+    }
+
+    if (__compile_dual_roles(button) != 0)
+    {
+        if (debug_printf)
+            debug_printf("Error: Invalid dual-role keys (max %d)\n", BITS_BTN_MAX_DUAL_ROLE_KEYS);
+        return -9;
+    }
+
+    if (__compile_priority_keys(button) != 0)
+    {
+        if (debug_printf)
+            debug_printf("Error: Invalid priority keys (max %d)\n", BITS_BTN_MAX_PRIORITY_KEYS);
+        return -10;
+    }
+
+    if (__build_sequence_trie(button) != 0)
+    {
+        if (debug_printf)
+            debug_printf("Error: Invalid key sequences (max %d trie nodes)\n", BITS_BTN_MAX_SEQUENCE_NODES);
+        button->seq_nodes_cnt = 0;
+        return -6;
+    }
+
+#ifdef BITS_BTN_USE_USER_BUFFER
+    if (bits_btn_buffer_ops == NULL)
     {
         if (debug_printf) debug_printf("Error: External buffer mode requires setting buffer ops!\n");
         return -4;
@@ -468,6 +1308,12 @@ int32_t bits_button_init(button_obj_t* btns
         bits_btn_buffer_ops->init();
     }
 
+    // Only a valid configuration is exposed to the runtime configuration API
+    bits_btn_config_combo_cnt = btns_combo_cnt;
+    for (uint8_t i = 0; i < button->compiled_params_cnt; i++)
+        bits_btn_config_params[i] = button->compiled_params[i].param;
+    bits_btn_config_params_cnt = button->compiled_params_cnt;
+
     return 0;
 }
 
@@ -480,7 +1326,11 @@ uint8_t bits_button_get_key_result(bits_btn_result_t *result)
 {
     if (bits_btn_buffer_ops && bits_btn_buffer_ops->read)
     {
-        return bits_btn_buffer_ops->read(result);
+        while (bits_btn_buffer_ops->read(result))
+        {
+            if (!__is_stale_result(result))
+                return true;
+        }
     }
     return false;
 }
@@ -494,66 +1344,383 @@ uint8_t bits_button_peek_key_result(bits_btn_result_t *result)
 {
     if (bits_btn_buffer_ops && bits_btn_buffer_ops->peek)
     {
+        __drop_stale_results();
         return bits_btn_buffer_ops->peek(result);
     }
     return false;
 }
 
+uint8_t bits_btn_buffer_acquire_view(bits_btn_buffer_view_t *view)
+{
+    if (view == NULL)
+        return false;
+
+#if !defined(BITS_BTN_DISABLE_BUFFER) && !defined(BITS_BTN_USE_USER_BUFFER)
+    __drop_stale_results();
+    return bits_btn_acquire_view_c11(view);
+#else
+    memset(view, 0, sizeof(*view));
+    return false;
+#endif
+}
+
+uint8_t bits_btn_buffer_release_view(const bits_btn_buffer_view_t *view)
+{
+    if (view == NULL)
+        return false;
+
+#if !defined(BITS_BTN_DISABLE_BUFFER) && !defined(BITS_BTN_USE_USER_BUFFER)
+    return bits_btn_release_view_c11(view);
+#else
+    return true;
+#endif
+}
+
 /**
-  * @brief  Reset all button states to idle.
-  *         This function should be called when resuming from low power mode
-  *         to clear any residual button states from before the pause.
-  * @retval None
+  * @brief  Read the level of every enabled key.
+  * @param  button: Pointer to the bits button object.
+  * @retval Mask of the keys at their active level.
   */
-void bits_button_reset_states(void)
+static button_mask_type_t __read_button_mask(bits_button_t *button)
 {
-    bits_button_t *button = &bits_btn_entity;
+    button_mask_type_t mask = 0;
+    button_mask_type_t read_mask = button->enabled_mask;
 
-    if (debug_printf)
-        debug_printf("Resetting all button states\n");
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    read_mask &= ~button->priority_mask;        // Sampled on their own by __process_priority_keys()
+#endif
 
-    // Reset all individual buttons
-    for (size_t i = 0; i < button->btns_cnt; i++)
+    for(size_t i = 0; i < button->btns_cnt; i++)
     {
-        button->btns[i].current_state = BTN_STATE_IDLE;
-        button->btns[i].last_state = BTN_STATE_IDLE;
-        button->btns[i].state_bits = 0;
-        button->btns[i].state_entry_time = 0;
-        button->btns[i].long_press_period_trigger_cnt = 0;
-    }
+        if (((read_mask >> i) & 1U) == 0)
+            continue;
 
-    // Reset all combo buttons
-    if (button->btns_combo != NULL && button->btns_combo_cnt > 0)
-    {
-        for (size_t i = 0; i < button->btns_combo_cnt; i++)
+        uint8_t read_gpio_level = button->_read_button_level(&button->btns[i]);
+
+        if (read_gpio_level == button->btns[i].active_level)
         {
-            button_obj_combo_t *combo = &button->btns_combo[i];
+            mask |= ((button_mask_type_t)1UL << i);
+        }
+    }
+
+    return mask;
+}
+
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+/**
+  * @brief  Apply leading-edge debounce to the eager keys: an edge is accepted at once, then
+  *         the key ignores further edges until its press or release lockout time has passed.
+  * @param  button: Pointer to the bits button object.
+  * @param  raw_mask: Mask read from the keys.
+  * @retval Mask with the accepted level of the eager keys.
+  */
+static button_mask_type_t __filter_eager_keys(bits_button_t *button, button_mask_type_t raw_mask)
+{
+    uint32_t now = get_button_tick();
+    button_mask_type_t locked_mask = button->eager_locked_mask;
+    button_mask_type_t edge_mask;
+
+    while (locked_mask)
+    {
+        uint8_t i = __lowest_bit_index(locked_mask);
+
+        locked_mask &= locked_mask - 1;
+        if (__is_deadline_reached(now, button->eager_lock_deadline[i]))
+            button->eager_locked_mask &= ~((button_mask_type_t)1UL << i);
+    }
+
+    edge_mask = (raw_mask ^ button->eager_level_mask) & button->eager_mask & ~button->eager_locked_mask;
+    button->eager_level_mask ^= edge_mask;
+    button->eager_locked_mask |= edge_mask;
+
+    while (edge_mask)
+    {
+        uint8_t i = __lowest_bit_index(edge_mask);
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << i;
+
+        edge_mask &= edge_mask - 1;
+        button->eager_lock_deadline[i] = now + ((raw_mask & btn_mask) ? button->press_debounce_time
+                                                                     : button->release_debounce_time);
+    }
+
+    return (raw_mask & ~button->eager_mask) | button->eager_level_mask;
+}
+#endif
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+/**
+  * @brief  Sample and debounce the priority keys, and report each level change to the
+  *         priority callback as soon as it has been stable for its debounce time.
+  * @param  button: Pointer to the bits button object.
+  * @param  sample: Raw sample of the port, or NULL to read the keys.
+  * @retval None
+  */
+static void __process_priority_keys(bits_button_t *button, const button_mask_type_t *sample)
+{
+    uint32_t now = get_button_tick();
+
+    for (uint8_t i = 0; i < button->priority_cnt; i++)
+    {
+        uint8_t index = button->priority_btn_index[i];
+        button_obj_t *btn = &button->btns[index];
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << index;
+        uint8_t pressed = (button->enabled_mask & btn_mask) &&
+                          (sample ? (*sample & btn_mask) != 0 : button->_read_button_level(btn) == btn->active_level);
+        bits_btn_result_t result = {0};
+
+        if (pressed == ((button->priority_pressed_mask & btn_mask) != 0))
+        {
+            // Back to the debounced level before the debounce time elapsed
+            button->priority_changing_mask &= ~btn_mask;
+            continue;
+        }
+
+        if ((button->priority_changing_mask & btn_mask) == 0)
+        {
+            button->priority_changing_mask |= btn_mask;
+            button->priority_deadline[i] = now + (pressed ? button->priority_press_time[i]
+                                                          : button->priority_release_time[i]);
+        }
+
+        if (!__is_deadline_reached(now, button->priority_deadline[i]))
+            continue;
+
+        button->priority_changing_mask &= ~btn_mask;
+        button->priority_pressed_mask ^= btn_mask;
+
+        result.event = pressed ? BTN_STATE_PRESSED : BTN_STATE_RELEASE;
+        result.key_id = btn->key_id;
+        result.key_value = pressed ? 0b1 : 0b10;
+
+        if (button->priority_cb)
+            button->priority_cb(btn, result);
+    }
+}
+#endif
+
+/**
+  * @brief  Request a reset of all button states to idle. Wait-free: the reset itself is
+  *         applied by the next bits_button_ticks() before it reads the keys.
+  * @retval true if the reset is requested, false if the engine is not initialized.
+  */
+uint8_t bits_button_reset_states(void)
+{
+    uint8_t epoch = (uint8_t)BITS_BTN_CONFIG_LOAD(bits_btn_reset_epoch);
+
+    if (!__engine_ready())
+        return false;
+
+    // Events reported up to the reset boundary keep the old epoch and are dropped by the readers
+    BITS_BTN_CONFIG_STORE(bits_btn_reset_epoch, (uint8_t)(epoch + 1));
+    return true;
+}
+
+/**
+  * @brief  Reset all button states to idle if bits_button_reset_states() was called.
+  *         Runs at a tick boundary, so it never interleaves with a dispatch.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __apply_pending_reset(bits_button_t *button)
+{
+    uint8_t epoch = (uint8_t)BITS_BTN_CONFIG_LOAD(bits_btn_reset_epoch);
+
+    if (epoch == bits_btn_applied_epoch)
+        return;
+
+    // Events reported from now on belong to the state after the reset
+    bits_btn_applied_epoch = epoch;
+
+    // Reset all individual buttons
+    for (size_t i = 0; i < button->btns_cnt; i++)
+    {
+        button->btns[i].current_state = BTN_STATE_IDLE;
+        button->btns[i].last_state = BTN_STATE_IDLE;
+        button->btns[i].state_bits = 0;
+        button->btns[i].history_chunks = 0;
+        button->btns[i].next_deadline = 0;
+        button->btns[i].long_press_period_trigger_cnt = 0;
+    }
+
+    // Reset all combo buttons
+    if (button->btns_combo_cnt > 0)
+    {
+        for (size_t i = 0; i < button->btns_combo_cnt; i++)
+        {
+            button_obj_combo_t *combo = button->combo_sorted[i];
             combo->btn.current_state = BTN_STATE_IDLE;
             combo->btn.last_state = BTN_STATE_IDLE;
             combo->btn.state_bits = 0;
-            combo->btn.state_entry_time = 0;
+            combo->btn.history_chunks = 0;
+            combo->btn.next_deadline = 0;
             combo->btn.long_press_period_trigger_cnt = 0;
         }
     }
 
     // Reset global button state and force mask synchronization
     // This prevents spurious release events after reset
-    button_mask_type_t current_physical_mask = 0;
-    for(size_t i = 0; i < button->btns_cnt; i++)
+    button_mask_type_t current_physical_mask = __read_button_mask(button);
+
+    button->current_mask = current_physical_mask;
+    button->last_mask = current_physical_mask;
+    button->debounce_deadline = get_button_tick() + button->press_debounce_time;
+    button->debounce_pending = true;
+
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+    button->eager_level_mask = current_physical_mask & button->eager_mask;
+    button->eager_locked_mask = 0;
+#endif
+
+    // Keys still held are picked up again by the first dispatch after the debounce window
+    button->dispatched_mask = current_physical_mask;
+    button->active_mask = 0;
+    button->next_due = button->debounce_deadline;
+    button->has_due = true;
+    button->seq_node = 0;
+    button->momentary_layer = BITS_BTN_NO_LAYER;
+    memset(button->combo_active_bits, 0, sizeof(button->combo_active_bits));
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    // Events held back for a combo belong to the state before the reset
+    button->deferred_mask = 0;
+    button->deferred_cnt = 0;
+#endif
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    button->dual_pending_mask = 0;
+    button->dual_hold_mask = 0;
+    button->dual_events_cnt = 0;
+#endif
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    // The debounced level of priority keys is kept, so a change during the pause is still reported
+    button->priority_changing_mask = 0;
+#endif
+
+    // Read the keys again on the next tick even if no pin change is notified
+    BITS_BTN_CONFIG_STORE(bits_btn_change_pending, 1);
+}
+
+uint32_t bits_button_get_time(void)
+{
+    return get_button_tick();
+}
+
+/**
+  * @brief  Get the time at which a button's state machine next needs to run.
+  * @param  btn: Pointer to the button object.
+  * @param  pressed: Whether the button (or all keys of a combo) is currently pressed.
+  * @param  now: Current time.
+  * @param  deadline: Pointer to store the deadline.
+  * @retval true if the button has a pending deadline, false if it stays idle until its input changes.
+  */
+static uint8_t __get_button_deadline(const button_obj_t *btn, uint8_t pressed, uint32_t now, uint32_t *deadline)
+{
+    if (btn->param_index == BITS_BTN_INVALID_PARAM_INDEX)
+        return false;
+
+    switch (btn->current_state)
     {
-        uint8_t read_gpio_level = button->_read_button_level(&button->btns[i]);
-        if (read_gpio_level == button->btns[i].active_level)
+        case BTN_STATE_PRESSED:
+        case BTN_STATE_LONG_PRESS:
+            // A release is handled on the next tick, otherwise wait for the long press or hold timeout
+            *deadline = pressed ? btn->next_deadline : now + 1;
+            return true;
+        case BTN_STATE_RELEASE_WINDOW:
+            *deadline = pressed ? now + 1 : btn->next_deadline;
+            return true;
+        case BTN_STATE_RELEASE:
+        case BTN_STATE_FINISH:
+            *deadline = now + 1;
+            return true;
+        default:
+            if (pressed)
+            {
+                *deadline = now + 1;
+                return true;
+            }
+            return false;
+    }
+}
+
+/**
+  * @brief  Keep the earlier of two deadlines, safe across tick counter wrap-around.
+  * @param  earliest: Pointer to the earliest deadline found so far.
+  * @param  found: Whether `earliest` holds a valid deadline.
+  * @param  now: Current time.
+  * @param  deadline: Candidate deadline.
+  * @retval None
+  */
+static void __keep_earliest_deadline(uint32_t *earliest, uint8_t found, uint32_t now, uint32_t deadline)
+{
+    if (!found || (int32_t)(deadline - now) < (int32_t)(*earliest - now))
+    {
+        *earliest = deadline;
+    }
+}
+
+uint8_t bits_button_get_next_deadline(uint32_t *deadline)
+{
+    bits_button_t *button = &bits_btn_entity;
+    uint32_t now = get_button_tick();
+    uint32_t earliest = 0;
+    uint8_t found = true;
+
+    if (deadline == NULL)
+        return false;
+
+    if (button->debounce_pending && !__is_deadline_reached(now, button->debounce_deadline))
+        earliest = button->debounce_deadline;   // No dispatch can run before the debounce window closes
+    else if (button->last_mask != button->dispatched_mask)
+        earliest = now + 1;
+    else if (button->has_due)
+        earliest = button->next_due;
+    else
+        found = false;
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    if (button->deferred_mask)
+    {
+        __keep_earliest_deadline(&earliest, found, now, button->deferred_deadline);
+        found = true;
+    }
+#endif
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    for (uint8_t i = 0; button->dual_pending_mask && i < button->dual_role_cnt; i++)
+    {
+        if (button->dual_pending_mask & ((button_mask_type_t)1UL << button->dual_role_btn_index[i]))
         {
-            current_physical_mask |= ((button_mask_type_t)1UL << i);
+            __keep_earliest_deadline(&earliest, found, now, button->dual_role_deadline[i]);
+            found = true;
         }
     }
+#endif
 
-    button->current_mask = current_physical_mask;
-    button->last_mask = current_physical_mask;
-    button->state_entry_time = get_button_tick();
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+    // An edge ignored during the lockout is taken when the lockout ends
+    for (button_mask_type_t locked_mask = button->eager_locked_mask; locked_mask; locked_mask &= locked_mask - 1)
+    {
+        __keep_earliest_deadline(&earliest, found, now, button->eager_lock_deadline[__lowest_bit_index(locked_mask)]);
+        found = true;
+    }
+#endif
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    for (uint8_t i = 0; button->priority_changing_mask && i < button->priority_cnt; i++)
+    {
+        if (button->priority_changing_mask & ((button_mask_type_t)1UL << button->priority_btn_index[i]))
+        {
+            __keep_earliest_deadline(&earliest, found, now, button->priority_deadline[i]);
+            found = true;
+        }
+    }
+#endif
+
+    if (found)
+        *deadline = earliest;
 
-    // Clear the event buffer
-    bits_btn_clear_buffer();
+    return found;
 }
 
 /**
@@ -568,318 +1735,1862 @@ static void __append_bit(state_bits_type_t* state_bits, uint8_t bit)
 }
 
 /**
-  * @brief  check number if match the target bits
-  * @param  state_bits: src number point.
-  * @param  target: tartget bits
-  * @param  target_bits_number: target bits number
-  * @retval 1 if it matches, 0 otherwise.
+  * @brief  check number if match the target bits
+  * @param  state_bits: src number point.
+  * @param  target: tartget bits
+  * @param  target_bits_number: target bits number
+  * @retval 1 if it matches, 0 otherwise.
+  */
+static uint8_t __check_if_the_bits_match(const key_value_type_t *state_bits, key_value_type_t target, uint8_t target_bits_number)
+{
+    key_value_type_t mask = ((key_value_type_t)1 << target_bits_number) - 1;
+
+    return (((*state_bits) & mask) == target? 1 : 0);
+}
+
+#if 0
+uint8_t check_is_repeat_click_mode(struct button_obj_t* button)
+{
+    key_value_type_t kv_input = button->key_value;
+
+    /* Check if the two least significant bits form 0b10 */
+    if((kv_input & 0b11) != 0b10)
+        return 0;
+
+    /* Calculate the XOR result */
+    key_value_type_t xor_result = kv_input ^ (kv_input >> 1);
+
+    /* Check if xor_result + 1 is a power of 2
+       This means all bits except the least significant one are 1 */
+    return (xor_result != 0) && (((xor_result + 1) & (xor_result - 1)) == 0);
+}
+#endif
+
+static void __advance_sequence(bits_button_t *button, struct button_obj_t* btn, const bits_btn_result_t *result);
+
+#if BITS_BTN_BATCH_SIZE > 0
+/**
+  * @brief  Pass the gathered events to the batch callback.
+  * @retval None
+  */
+static void __flush_batch(void)
+{
+    uint16_t cnt = bits_btn_batch_cnt;
+
+    if (cnt == 0)
+        return;
+
+    bits_btn_batch_cnt = 0;
+    bits_btn_batch_combo_cnt = 0;
+
+    if (bits_btn_batch_cb)
+        bits_btn_batch_cb(bits_btn_batch, cnt);
+}
+
+/**
+  * @brief  Add an event to the batch of the running tick, combo events behind the other combo events.
+  * @param  btn: Button object that reported the event.
+  * @param  result: Pointer to the button result.
+  * @retval None
+  */
+static void __stage_batch_event(struct button_obj_t *btn, const bits_btn_result_t *result)
+{
+    const bits_button_t *button = &bits_btn_entity;
+    uint16_t pos = bits_btn_batch_cnt;
+
+    if (bits_btn_batch_cnt == BITS_BTN_BATCH_SIZE)
+    {
+        __flush_batch();
+        pos = 0;
+    }
+
+    if (btn < button->btns || btn >= button->btns + button->btns_cnt)
+    {
+        pos = bits_btn_batch_combo_cnt++;
+        memmove(&bits_btn_batch[pos + 1], &bits_btn_batch[pos], (bits_btn_batch_cnt - pos) * sizeof(bits_btn_batch[0]));
+    }
+
+    bits_btn_batch[pos] = *result;
+    bits_btn_batch_cnt++;
+}
+
+/**
+  * @brief  Flush the batch at the end of a tick or a sample feed. In deferred callback mode
+  *         bits_button_process() stages and flushes the batch instead, so the tick leaves it alone.
+  * @retval None
+  */
+static void __flush_tick_batch(void)
+{
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    if (bits_btn_deferred_callbacks)
+        return;
+#endif
+
+    __flush_batch();
+}
+#endif
+
+/**
+  * @brief  Run the debug output, the result filter, the buffer write and the result callback of an event.
+  * @param  button: Pointer to the button object.
+  * @param  result: Pointer to the button result to be reported.
+  * @retval None
+  */
+static void __run_event_callbacks(struct button_obj_t* button, bits_btn_result_t *result)
+{
+    bits_btn_result_callback btn_result_cb = bits_btn_entity.bits_btn_result_cb;
+
+    if(debug_printf)
+        debug_printf("key id[%d],event:%d, long trigger_cnt:%d, key_value:", result->key_id, result->event ,result->long_press_period_trigger_cnt);
+    debug_print_binary(result->key_value);
+
+#ifndef BITS_BTN_DISABLE_BUFFER
+    uint8_t is_user_result_filter_exist = (bits_btn_result_user_filter_cb != NULL);
+
+    if (bits_btn_buffer_ops && bits_btn_buffer_ops->write)
+    {
+        uint8_t should_write_to_buffer = 0;
+
+        if (is_user_result_filter_exist)
+        {
+            should_write_to_buffer = bits_btn_result_user_filter_cb(*result);
+        }
+        else
+        {
+            const bits_button_t *entity = &bits_btn_entity;
+            button_mask_type_t key_bit = ~(button_mask_type_t)0;     // Combos and sequences pass the key filter
+
+            if (button >= entity->btns && button < entity->btns + entity->btns_cnt)
+                key_bit = (button_mask_type_t)1 << (button - entity->btns);
+
+            should_write_to_buffer = (bits_btn_filter_event_mask & BITS_BTN_EVENT_BIT(result->event)) &&
+                                     (bits_btn_filter_key_mask & key_bit);
+        }
+
+        if (should_write_to_buffer)
+        {
+            bits_btn_buffer_ops->write(result);
+        }
+    }
+#endif
+
+#if BITS_BTN_BATCH_SIZE > 0
+    if (bits_btn_batch_cb)
+    {
+        __stage_batch_event(button, result);
+        return;
+    }
+#endif
+
+    if(btn_result_cb)
+        btn_result_cb(button, *result);
+}
+
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+/**
+  * @brief  Record an event for bits_button_process() in deferred callback mode.
+  * @param  button: Pointer to the button object.
+  * @param  result: Pointer to the button result.
+  * @retval None
+  */
+static void __queue_event(struct button_obj_t* button, const bits_btn_result_t *result)
+{
+    uint16_t write_idx = BITS_BTN_CONFIG_LOAD(bits_btn_event_write_idx);
+    uint16_t read_idx = BITS_BTN_CONFIG_LOAD(bits_btn_event_read_idx);
+    uint16_t next_idx = (write_idx + 1) % BITS_BTN_EVENT_QUEUE_SIZE;
+    uint16_t used = (uint16_t)((write_idx + BITS_BTN_EVENT_QUEUE_SIZE - read_idx) % BITS_BTN_EVENT_QUEUE_SIZE);
+
+    if (next_idx == read_idx)
+    {
+        bits_btn_tick_stats.dropped_events++;
+        return;
+    }
+
+    bits_btn_event_queue[write_idx].btn = button;
+    bits_btn_event_queue[write_idx].result = *result;
+    BITS_BTN_CONFIG_STORE(bits_btn_event_write_idx, next_idx);
+
+    if (used + 1 > bits_btn_tick_stats.queue_high_water)
+        bits_btn_tick_stats.queue_high_water = used + 1;
+}
+#endif
+
+/**
+  * @brief  Deliver a button event to the buffer and the result callback, or record it for
+  *         bits_button_process() in deferred callback mode.
+  * @param  button: Pointer to the button object.
+  * @param  result: Pointer to the button result to be reported.
+  * @retval None
+  */
+static void bits_btn_deliver_event(struct button_obj_t* button, bits_btn_result_t *result)
+{
+    if(result == NULL) return;
+
+    bits_btn_tick_event_cnt++;
+    result->reset_epoch = bits_btn_applied_epoch;
+
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    if (bits_btn_deferred_callbacks)
+        __queue_event(button, result);
+    else
+#endif
+        __run_event_callbacks(button, result);
+
+    __advance_sequence(&bits_btn_entity, button, result);
+}
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+/**
+  * @brief  Find the dual-role slot of a single button.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn_index: Index of the single button.
+  * @retval Slot index, or -1 if the button is not a dual-role key.
+  */
+static int __find_dual_role(const bits_button_t *button, uint8_t btn_index)
+{
+    for (uint8_t i = 0; i < button->dual_role_cnt; i++)
+    {
+        if (button->dual_role_btn_index[i] == btn_index)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+  * @brief  Report the events of a held gesture of a dual-role key under its hold key ID.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn: Pointer to the button object that generated the event.
+  * @param  result: Pointer to the event.
+  * @retval None
+  */
+static void __apply_dual_role(const bits_button_t *button, const struct button_obj_t* btn, bits_btn_result_t *result)
+{
+    if (btn < button->btns || btn >= button->btns + button->btns_cnt)
+        return;
+
+    uint8_t index = (uint8_t)(btn - button->btns);
+
+    if (button->dual_hold_mask & ((button_mask_type_t)1UL << index))
+        result->key_id = bits_btn_dual_roles[__find_dual_role(button, index)].hold_key_id;
+}
+
+/**
+  * @brief  Report the events held back while dual-role keys were undecided, in their original order.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __flush_dual_role_events(bits_button_t *button)
+{
+    uint8_t cnt = button->dual_events_cnt;
+
+    button->dual_events_cnt = 0;
+
+    for (uint8_t i = 0; i < cnt; i++)
+    {
+        bits_btn_deferred_event_t *entry = &button->dual_events[i];
+
+        __apply_dual_role(button, entry->btn, &entry->result);
+        bits_btn_deliver_event(entry->btn, &entry->result);
+    }
+}
+
+/**
+  * @brief  Decide the undecided dual-role keys whose outcome is certain: a released key is a
+  *         tap; a key held past its hold time, or held while another key was pressed and
+  *         released (permissive hold), is a hold. The held back events are reported once no
+  *         key is left undecided.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __resolve_dual_roles(bits_button_t *button)
+{
+    uint32_t now = get_button_tick();
+
+    if (button->dual_pending_mask == 0)
+        return;
+
+    for (uint8_t i = 0; i < button->dual_role_cnt; i++)
+    {
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << button->dual_role_btn_index[i];
+
+        if ((button->dual_pending_mask & btn_mask) == 0)
+            continue;
+
+        if ((button->dispatched_mask & btn_mask) == 0)
+        {
+            button->dual_pending_mask &= ~btn_mask;
+        }
+        else if (__is_deadline_reached(now, button->dual_role_deadline[i]) ||
+                 (button->dual_role_other_mask[i] & ~button->dispatched_mask))
+        {
+            button->dual_pending_mask &= ~btn_mask;
+            button->dual_hold_mask |= btn_mask;
+        }
+    }
+
+    if (button->dual_pending_mask == 0)
+        __flush_dual_role_events(button);
+}
+
+/**
+  * @brief  Hold back an event while a dual-role key is undecided. The first press of a
+  *         dual-role key starts its decision; presses of other keys meanwhile are recorded
+  *         for the permissive hold check.
+  * @param  btn: Pointer to the button object that generated the event.
+  * @param  result: Pointer to the event, rewritten for a decided hold.
+  * @retval true if the event was queued, false if it must be delivered now.
+  */
+static uint8_t __hold_dual_role_event(struct button_obj_t* btn, bits_btn_result_t *result)
+{
+    bits_button_t *button = &bits_btn_entity;
+
+    if (button->dual_role_cnt == 0)
+        return false;
+
+    if (btn >= button->btns && btn < button->btns + button->btns_cnt && result->event == BTN_STATE_PRESSED)
+    {
+        uint8_t index = (uint8_t)(btn - button->btns);
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << index;
+
+        for (uint8_t i = 0; button->dual_pending_mask && i < button->dual_role_cnt; i++)
+        {
+            if (button->dual_pending_mask & ((button_mask_type_t)1UL << button->dual_role_btn_index[i]))
+                button->dual_role_other_mask[i] |= btn_mask;
+        }
+
+        // A new gesture of a dual-role key starts undecided
+        if ((button->dual_role_mask & btn_mask) && result->key_value == 0b1)
+        {
+            int slot = __find_dual_role(button, index);
+
+            button->dual_pending_mask |= btn_mask;
+            button->dual_hold_mask &= ~btn_mask;
+            button->dual_role_deadline[slot] = get_button_tick() + button->dual_role_hold_time[slot];
+            button->dual_role_other_mask[slot] = 0;
+        }
+    }
+
+    if (button->dual_pending_mask == 0)
+    {
+        __apply_dual_role(button, btn, result);
+        return false;
+    }
+
+    if (button->dual_events_cnt >= BITS_BTN_DUAL_ROLE_EVENT_SIZE)
+    {
+        // Queue full: so many keys under an undecided key are taken as a hold
+        button->dual_hold_mask |= button->dual_pending_mask;
+        button->dual_pending_mask = 0;
+        __flush_dual_role_events(button);
+        __apply_dual_role(button, btn, result);
+        return false;
+    }
+
+    button->dual_events[button->dual_events_cnt].btn = btn;
+    button->dual_events[button->dual_events_cnt].result = *result;
+    button->dual_events_cnt++;
+
+    return true;
+}
+#endif
+
+/**
+  * @brief  Report an event that passed the combo term: hold it back while a dual-role key
+  *         is undecided, deliver it otherwise.
+  * @param  button: Pointer to the button object.
+  * @param  result: Pointer to the button result to be reported.
+  * @retval None
+  */
+static void __report_decided_event(struct button_obj_t* button, bits_btn_result_t *result)
+{
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    if (__hold_dual_role_event(button, result))
+        return;
+#endif
+
+    bits_btn_deliver_event(button, result);
+}
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+/**
+  * @brief  Take the held back events of some member keys out of the deferred queue.
+  * @param  button: Pointer to the bits button object.
+  * @param  keys_mask: Keys whose events are taken out of the queue.
+  * @param  deliver: true to report the events in their original order, false to drop them.
+  * @retval None
+  */
+static void __take_deferred_events(bits_button_t *button, button_mask_type_t keys_mask, uint8_t deliver)
+{
+    uint8_t kept = 0;
+
+    keys_mask &= button->deferred_mask;
+    if (keys_mask == 0)
+        return;
+
+    button->deferred_mask &= ~keys_mask;
+
+    for (uint8_t i = 0; i < button->deferred_cnt; i++)
+    {
+        bits_btn_deferred_event_t *entry = &button->deferred_events[i];
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << (entry->btn - button->btns);
+
+        if ((keys_mask & btn_mask) == 0)
+        {
+            button->deferred_events[kept++] = *entry;
+        }
+        else if (deliver)
+        {
+            __report_decided_event(entry->btn, &entry->result);
+        }
+    }
+
+    button->deferred_cnt = kept;
+}
+
+/**
+  * @brief  Finish the gestures that the retracted presses interrupted. A member key pressed
+  *         again within its release window has already reported the earlier presses of the
+  *         gesture, so that part is closed with a FINISH instead of being dropped.
+  * @param  button: Pointer to the bits button object.
+  * @param  keys_mask: Deferred keys being retracted.
+  * @retval None
+  */
+static void __finish_interrupted_gestures(bits_button_t *button, button_mask_type_t keys_mask)
+{
+    for (uint8_t i = 0; keys_mask && i < button->deferred_cnt; i++)
+    {
+        bits_btn_deferred_event_t *entry = &button->deferred_events[i];
+        button_mask_type_t btn_mask = (button_mask_type_t)1UL << (entry->btn - button->btns);
+
+        if ((keys_mask & btn_mask) == 0)
+            continue;
+
+        // The first held back event of a key is the press that opened its combo term
+        keys_mask &= ~btn_mask;
+        if (entry->result.event == BTN_STATE_PRESSED && (entry->result.key_value >> 1) != 0)
+        {
+            bits_btn_result_t result = entry->result;
+
+            result.event = BTN_STATE_FINISH;
+            result.key_value >>= 1;
+            result.long_press_period_trigger_cnt = 0;
+            __report_decided_event(entry->btn, &result);
+        }
+    }
+}
+
+/**
+  * @brief  Drop the held back events of keys that completed a combo, and restart those
+  *         keys from idle so their press is only seen as part of the combo.
+  * @param  button: Pointer to the bits button object.
+  * @param  combo_mask: Keys of the combo that just became active.
+  * @retval None
+  */
+static void __retract_deferred_events(bits_button_t *button, button_mask_type_t combo_mask)
+{
+    button_mask_type_t keys_mask = combo_mask & button->deferred_mask;
+
+    __finish_interrupted_gestures(button, keys_mask);
+    __take_deferred_events(button, keys_mask, false);
+
+    while (keys_mask)
+    {
+        uint8_t i = __lowest_bit_index(keys_mask);
+        button_obj_t *btn = &button->btns[i];
+
+        keys_mask &= keys_mask - 1;
+
+        btn->current_state = BTN_STATE_IDLE;
+        btn->last_state = BTN_STATE_IDLE;
+        btn->state_bits = 0;
+        btn->history_chunks = 0;
+        btn->long_press_period_trigger_cnt = 0;
+        button->active_mask &= ~((button_mask_type_t)1UL << i);
+    }
+}
+
+/**
+  * @brief  Report the held back events whose combo term expired or whose key was released.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __release_deferred_events(bits_button_t *button)
+{
+    if (button->deferred_mask == 0)
+        return;
+
+    if (__is_deadline_reached(get_button_tick(), button->deferred_deadline))
+    {
+        __take_deferred_events(button, button->deferred_mask, true);
+    }
+    else
+    {
+        // A released key can no longer complete its combo
+        __take_deferred_events(button, button->deferred_mask & ~button->dispatched_mask, true);
+    }
+}
+
+/**
+  * @brief  Hold back an event of a combo member key while its combo may still complete.
+  *         A press of a member key opens the combo term; events of deferred keys are
+  *         queued until the term expires, the key is released or the combo completes.
+  * @param  btn: Pointer to the button object that generated the event.
+  * @param  result: Pointer to the event.
+  * @retval true if the event was queued, false if it must be delivered now.
+  */
+static uint8_t __defer_combo_member_event(struct button_obj_t* btn, const bits_btn_result_t *result)
+{
+    bits_button_t *button = &bits_btn_entity;
+
+    // Combo buttons are never deferred
+    if (btn < button->btns || btn >= button->btns + button->btns_cnt)
+        return false;
+
+    button_mask_type_t btn_mask = (button_mask_type_t)1UL << (btn - button->btns);
+
+    if ((button->combo_member_mask & btn_mask) == 0)
+        return false;
+
+    if ((button->deferred_mask & btn_mask) == 0)
+    {
+        if (result->event != BTN_STATE_PRESSED)
+            return false;
+
+        if (button->deferred_mask == 0)
+            button->deferred_deadline = get_button_tick() + button->combo_term_time;
+        button->deferred_mask |= btn_mask;
+    }
+
+    if (button->deferred_cnt >= BITS_BTN_DEFERRED_EVENT_SIZE)
+    {
+        // Queue full: stop waiting rather than lose events
+        __take_deferred_events(button, button->deferred_mask, true);
+        return false;
+    }
+
+    button->deferred_events[button->deferred_cnt].btn = btn;
+    button->deferred_events[button->deferred_cnt].result = *result;
+    button->deferred_cnt++;
+
+    return true;
+}
+#endif
+
+/**
+  * @brief  Report a button event.
+  * @param  button: Pointer to the button object.
+  * @param  result: Pointer to the button result to be reported.
+  * @retval None
+  */
+static void bits_btn_report_event(struct button_obj_t* button, bits_btn_result_t *result)
+{
+    if(result == NULL) return;
+
+    result->history_chunk = button->history_chunks;
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    if (__defer_combo_member_event(button, result))
+        return;
+#endif
+
+    __report_decided_event(button, result);
+}
+
+/**
+  * @brief  Advance the sequence trie with a delivered event. Only presses of single buttons
+  *         are steps; a press that does not continue the current sequence may start a new one.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn: Pointer to the button object that generated the event.
+  * @param  result: Pointer to the delivered event.
+  * @retval None
+  */
+static void __advance_sequence(bits_button_t *button, struct button_obj_t* btn, const bits_btn_result_t *result)
+{
+    if (button->seq_nodes_cnt == 0 || result->event != BTN_STATE_PRESSED)
+        return;
+
+    if (btn < button->btns || btn >= button->btns + button->btns_cnt)
+        return;
+
+    uint32_t now = get_button_tick();
+    button_mask_type_t btn_mask = (button_mask_type_t)1UL << (btn - button->btns);
+    const bits_btn_seq_node_t *node = &button->seq_nodes[button->seq_node];
+
+    if ((node->child_mask & btn_mask) == 0 || __is_deadline_reached(now, button->seq_deadline))
+        node = &button->seq_nodes[0];
+
+    if ((node->child_mask & btn_mask) == 0)
+    {
+        button->seq_node = 0;
+        return;
+    }
+
+    button->seq_node = node->first_child + __count_bits(node->child_mask & (btn_mask - 1));
+    node = &button->seq_nodes[button->seq_node];
+    button->seq_deadline = now + node->timeout_time;
+
+    if (node->match != BITS_BTN_SEQ_NO_MATCH)
+    {
+        bits_btn_sequence_t *seq = &bits_btn_sequences[node->match];
+        bits_btn_result_t seq_result = {0};
+
+        // A sequence that is not the prefix of a longer one starts over
+        if (node->child_mask == 0)
+            button->seq_node = 0;
+
+        seq_result.key_id = seq->btn.key_id;
+        seq_result.event = BTN_STATE_FINISH;
+        seq_result.key_value = BITS_BTN_SINGLE_CLICK_KV;
+        bits_btn_report_event(&seq->btn, &seq_result);
+    }
+}
+
+/**
+  * @brief  Get the key ID reported for a button's events: the keymap key ID of the layer
+  *         latched by the current gesture for single buttons, the button's own key ID otherwise.
+  * @param  button: Pointer to the button object.
+  * @retval Key ID to report.
+  */
+static uint16_t __get_event_key_id(const struct button_obj_t* button)
+{
+    const bits_button_t *entity = &bits_btn_entity;
+
+    if (entity->layer_cnt == 0 || button < entity->btns || button >= entity->btns + entity->btns_cnt)
+        return button->key_id;
+
+    return bits_btn_keymap[button->layer * entity->btns_cnt + (button - entity->btns)].key_id;
+}
+
+/**
+  * @brief  Latch the active layer when a single button starts a new gesture, and run the
+  *         layer action of its keymap entry.
+  * @param  button: Pointer to the button object.
+  * @retval None
+  */
+static void __latch_layer(struct button_obj_t* button)
+{
+    bits_button_t *entity = &bits_btn_entity;
+
+    if (entity->layer_cnt == 0 || button < entity->btns || button >= entity->btns + entity->btns_cnt)
+        return;
+
+    uint8_t btn_index = (uint8_t)(button - entity->btns);
+    uint16_t map_index = bits_button_get_layer() * entity->btns_cnt + btn_index;
+    const bits_btn_keymap_entry_t *entry = &bits_btn_keymap[map_index];
+
+    button->layer = bits_button_get_layer();
+    button->param_index = entity->keymap_param_index[map_index];
+
+    if (entry->action == BITS_BTN_ACTION_LAYER_TO)
+    {
+        entity->base_layer = entry->action_layer;
+    }
+    else if (entry->action == BITS_BTN_ACTION_LAYER_MO)
+    {
+        entity->momentary_layer = entry->action_layer;
+        entity->momentary_owner = btn_index;
+    }
+}
+
+/**
+  * @brief  Drop the momentary layer when the key holding it is released.
+  * @param  button: Pointer to the button object.
+  * @retval None
+  */
+static void __release_layer(const struct button_obj_t* button)
+{
+    bits_button_t *entity = &bits_btn_entity;
+
+    if (entity->momentary_layer != BITS_BTN_NO_LAYER && button == &entity->btns[entity->momentary_owner])
+        entity->momentary_layer = BITS_BTN_NO_LAYER;
+}
+
+/**
+  * @brief  Make room in the gesture history before a new press is recorded.
+  *         A single press appends at most BITS_BTN_PRESS_MAX_BITS bits (press, long press,
+  *         hold, release). If they might not fit, the current history is reported as a
+  *         BTN_EVENT_HISTORY_OVERFLOW chunk and restarted, so every chunk begins with a
+  *         press bit and the full sequence is the concatenation of all reported chunks.
+  *         Later results of the gesture carry the chunk count in history_chunk, so their
+  *         key_value is not taken for a short gesture.
+  * @param  button: Pointer to the button object.
+  * @retval None
+  */
+static void __flush_history_if_full(struct button_obj_t* button)
+{
+    if ((button->state_bits >> (BITS_BTN_STATE_BITS_WIDTH - BITS_BTN_PRESS_MAX_BITS)) == 0)
+        return;
+
+    bits_btn_result_t result = {0};
+    result.key_id = __get_event_key_id(button);
+    result.event = BTN_EVENT_HISTORY_OVERFLOW;
+    result.key_value = button->state_bits;
+    bits_btn_report_event(button, &result);
+
+    button->state_bits = 0;
+    if (button->history_chunks < UINT8_MAX)
+        button->history_chunks++;
+}
+
+/**
+  * @brief  Update the button state machine.
+  * @param  button: Pointer to the button object.
+  * @param  btn_pressed: Flag indicating whether the button is pressed.
+  * @retval None
+  */
+static void update_button_state_machine(struct button_obj_t* button, uint8_t btn_pressed)
+{
+    uint32_t current_time = get_button_tick();
+    uint8_t deadline_reached = __is_deadline_reached(current_time, button->next_deadline);
+    bits_btn_result_t result = {0};
+
+    // A press from idle with no history starts a new gesture in the active layer
+    if (button->current_state == BTN_STATE_IDLE && btn_pressed && button->state_bits == 0)
+        __latch_layer(button);
+
+    result.key_id = __get_event_key_id(button);
+
+    if(button->param_index == BITS_BTN_INVALID_PARAM_INDEX)
+        return;
+
+    const bits_btn_compiled_param_t *param = &bits_btn_entity.compiled_params[button->param_index];
+
+    switch (button->current_state)
+    {
+        case BTN_STATE_IDLE:
+            if (btn_pressed)
+            {
+                __flush_history_if_full(button);
+                __append_bit(&button->state_bits, 1);
+
+                button->current_state = BTN_STATE_PRESSED;
+                button->next_deadline = current_time + param->long_press_start_time;
+
+                result.key_value = button->state_bits;
+                result.event = button->current_state;
+                bits_btn_report_event(button, &result);
+            }
+            break;
+        case BTN_STATE_PRESSED:
+            if (deadline_reached)
+            {
+                __append_bit(&button->state_bits, 1);
+
+                button->current_state = BTN_STATE_LONG_PRESS;
+                button->next_deadline += param->long_press_period_time;
+                button->long_press_period_trigger_cnt = 0;
+
+                result.key_value = button->state_bits;
+                result.event = button->current_state;
+                bits_btn_report_event(button, &result);
+            }
+            else if (btn_pressed == 0)
+            {
+                __release_layer(button);
+                button->current_state = BTN_STATE_RELEASE;
+                button->next_deadline = current_time + param->time_window_time;
+            }
+            break;
+        case BTN_STATE_LONG_PRESS:
+            if (btn_pressed == 0)
+            {
+                __release_layer(button);
+                button->long_press_period_trigger_cnt = 0;
+                button->current_state = BTN_STATE_RELEASE;
+                button->next_deadline = current_time + param->time_window_time;
+            }
+            else if(deadline_reached)
+            {
+                button->long_press_period_trigger_cnt++;
+                // Schedule from the previous deadline so late ticks do not stretch the hold period
+                button->next_deadline += __get_hold_period(param, button->long_press_period_trigger_cnt);
+
+                if(__check_if_the_bits_match(&button->state_bits, 0b011, 3))
+                {
+                    __append_bit(&button->state_bits, 1);
+                }
+
+                result.key_value = button->state_bits;
+                result.event = button->current_state;
+                result.long_press_period_trigger_cnt = button->long_press_period_trigger_cnt;
+                bits_btn_report_event(button, &result);
+            }
+            break;
+        case BTN_STATE_RELEASE:
+            __append_bit(&button->state_bits, 0);
+
+            result.key_value = button->state_bits;
+            result.event = BTN_STATE_RELEASE;
+            bits_btn_report_event(button, &result);
+
+            // The release window deadline was set when the release was detected
+            button->current_state = BTN_STATE_RELEASE_WINDOW;
+
+            break;
+        case BTN_STATE_RELEASE_WINDOW:
+            if (btn_pressed)
+            {
+                button->current_state = BTN_STATE_IDLE;
+            }
+            else if (deadline_reached)
+            {
+                // Time window timeout, trigger event and return to idle
+                button->current_state = BTN_STATE_FINISH;
+            }
+            break;
+        case BTN_STATE_FINISH:
+
+            result.key_value = button->state_bits;
+            result.event = BTN_STATE_FINISH;
+            bits_btn_report_event(button, &result);
+
+            button->state_bits = 0;
+            button->history_chunks = 0;
+            button->current_state = BTN_STATE_IDLE;
+            break;
+        default:
+            break;
+
+    }
+
+    if(button->last_state != button->current_state)
+    {
+#if 0
+        if(debug_printf)
+            debug_printf("id[%d]:cur status:%d,last:%d\n", button->key_id, button->current_state, button->last_state);
+#endif
+        button->last_state = button->current_state;
+    }
+}
+
+/**
+  * @brief  Handle the button state based on the current mask and button mask.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn: Pointer to the button object.
+  * @param  btn_mask: The button mask of the specific button.
+  * @retval None
+  */
+static void handle_button_state(bits_button_t *button, struct button_obj_t* btn, button_mask_type_t btn_mask)
+{
+    uint8_t pressed = (button->dispatched_mask & btn_mask) == btn_mask? 1 : 0;
+    uint32_t deadline;
+
+    update_button_state_machine(btn, pressed);
+
+    // Record when this state machine needs to run again, so idle ticks can skip dispatching
+    if (__get_button_deadline(btn, pressed, button->btn_tick, &deadline))
+    {
+        __keep_earliest_deadline(&button->next_due, button->has_due, button->btn_tick, deadline);
+        button->has_due = true;
+    }
+}
+
+/**
+  * @brief  Scalar reference for __get_combo_pressed_bits().
+  * @param  masks: Combo masks in priority order.
+  * @param  first: First combo to evaluate.
+  * @param  cnt: Number of combos.
+  * @param  current_mask: Debounced button mask.
+  * @param  bits: Bitmap receiving one set bit per fully pressed combo.
+  * @retval None
+  */
+static void __get_combo_pressed_bits_scalar(const button_mask_type_t *masks, uint16_t first, uint16_t cnt,
+                                            button_mask_type_t current_mask, uint32_t *bits)
+{
+    for (uint16_t i = first; i < cnt; i++)
+    {
+        if ((current_mask & masks[i]) == masks[i])
+            bits[i >> 5] |= (uint32_t)1UL << (i & 31);
+    }
+}
+
+#ifdef BITS_BTN_SIMD_LANES
+/**
+  * @brief  Evaluate BITS_BTN_SIMD_LANES consecutive combo masks at once.
+  * @param  masks: First of the combo masks.
+  * @param  current_mask: Debounced button mask.
+  * @retval Lane bitmap, bit n set if combo n is fully pressed.
+  */
+static uint32_t __get_combo_pressed_lanes(const button_mask_type_t *masks, button_mask_type_t current_mask)
+{
+#if defined(__AVX2__)
+    __m256i current = _mm256_set1_epi32((int)current_mask);
+    __m256i combo = _mm256_loadu_si256((const __m256i *)masks);
+    __m256i pressed = _mm256_cmpeq_epi32(_mm256_and_si256(current, combo), combo);
+    return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(pressed));
+#elif defined(__SSE2__)
+    __m128i current = _mm_set1_epi32((int)current_mask);
+    __m128i combo = _mm_loadu_si128((const __m128i *)masks);
+    __m128i pressed = _mm_cmpeq_epi32(_mm_and_si128(current, combo), combo);
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(pressed));
+#else
+    static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+    uint32x4_t current = vdupq_n_u32(current_mask);
+    uint32x4_t combo = vld1q_u32(masks);
+    uint32x4_t pressed = vandq_u32(vceqq_u32(vandq_u32(current, combo), combo), vld1q_u32(lane_bits));
+    uint32x2_t sum = vadd_u32(vget_low_u32(pressed), vget_high_u32(pressed));
+    return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+}
+#endif
+
+/**
+  * @brief  Compute which combos are fully pressed, several combos per instruction where
+  *         a vector unit is available.
+  * @param  masks: Combo masks in priority order.
+  * @param  cnt: Number of combos.
+  * @param  current_mask: Debounced button mask.
+  * @param  bits: Bitmap of BITS_BTN_COMBO_BITMAP_WORDS words, bit i set if combo i is fully pressed.
+  * @retval None
+  */
+static void __get_combo_pressed_bits(const button_mask_type_t *masks, uint16_t cnt,
+                                     button_mask_type_t current_mask, uint32_t *bits)
+{
+    uint16_t i = 0;
+
+    memset(bits, 0, BITS_BTN_COMBO_BITMAP_WORDS * sizeof(uint32_t));
+
+#ifdef BITS_BTN_SIMD_LANES
+    // The lane count divides 32, so a group never straddles two bitmap words
+    for (; i + BITS_BTN_SIMD_LANES <= cnt; i += BITS_BTN_SIMD_LANES)
+    {
+        bits[i >> 5] |= __get_combo_pressed_lanes(&masks[i], current_mask) << (i & 31);
+    }
+#endif
+
+    __get_combo_pressed_bits_scalar(masks, i, cnt, current_mask, bits);
+}
+
+/**
+  * @brief  Dispatch and process combo buttons and generate a suppression mask.
+  *         Only combos that are fully pressed or still hold a gesture are visited,
+  *         in priority order.
+  * @param  button: Pointer to the bits button object.
+  * @param  suppression_mask: Pointer to store the suppression mask.
+  * @retval None
+  */
+static void dispatch_combo_buttons(bits_button_t *button, button_mask_type_t *suppression_mask)
+{
+    uint32_t pressed_bits[BITS_BTN_COMBO_BITMAP_WORDS];
+
+    if(button->btns_combo_cnt == 0) return;
+
+    button_mask_type_t activated_mask = 0;
+
+    __get_combo_pressed_bits(button->combo_masks, button->btns_combo_cnt, button->dispatched_mask, pressed_bits);
+
+    for (uint16_t w = 0; w < BITS_BTN_COMBO_BITMAP_WORDS; w++)
+    {
+        // An idle combo that is not fully pressed can neither move nor activate
+        uint32_t pending_bits = pressed_bits[w] | button->combo_active_bits[w];
+
+        while (pending_bits)
+        {
+            uint16_t i = (uint16_t)(w * 32 + __lowest_bit_index(pending_bits));
+            uint32_t combo_bit = (uint32_t)1UL << (i & 31);
+            button_obj_combo_t* combo = button->combo_sorted[i];
+            button_mask_type_t combo_mask = button->combo_masks[i];
+
+            pending_bits &= pending_bits - 1;
+
+            // Check if the current combo button is covered by a more specific combo button
+            if (activated_mask & combo_mask)
+            {
+                // Already covered, skip processing
+                continue;
+            }
+
+            // Handle state transitions for this combo button
+            handle_button_state(button, &combo->btn, combo_mask);
+
+            // A combo keeps activating while it holds history, even from idle
+            if (combo->btn.current_state != BTN_STATE_IDLE || combo->btn.state_bits)
+                button->combo_active_bits[w] |= combo_bit;
+            else
+                button->combo_active_bits[w] &= ~combo_bit;
+
+            if ((pressed_bits[w] & combo_bit) || combo->btn.state_bits)
+            {
+                // Mark the current combo button as activated
+                activated_mask |= combo_mask;
+
+                if (combo->suppress)
+                {
+                    *suppression_mask |= combo_mask;
+#if BITS_BTN_COMBO_TERM_MS > 0
+                    __retract_deferred_events(button, combo_mask);
+#endif
+                }
+            }
+        }
+    }
+}
+
+/**
+  * @brief  Dispatch and process unsuppressed individual buttons.
+  *         Only buttons that are pressed or not yet back to idle are visited.
+  * @param  button: Pointer to the bits button object.
+  * @param  suppression_mask: The suppression mask.
+  * @retval None
+  */
+static void dispatch_unsuppressed_buttons(bits_button_t *button, button_mask_type_t suppression_mask)
+{
+    // Skip individual buttons suppressed by combo buttons
+    button_mask_type_t pending_mask = (button->active_mask | button->dispatched_mask) & ~suppression_mask;
+
+    while (pending_mask)
+    {
+        uint8_t i = __lowest_bit_index(pending_mask);
+        button_mask_type_t btn_mask = ((button_mask_type_t)1UL << i);
+
+        pending_mask &= pending_mask - 1;
+
+        handle_button_state(button, &button->btns[i], btn_mask);
+
+        if (button->btns[i].current_state != BTN_STATE_IDLE)
+            button->active_mask |= btn_mask;
+        else
+            button->active_mask &= ~btn_mask;
+    }
+}
+
+/**
+  * @brief  Run the state machines once the input is debounced.
+  *         Nothing is dispatched if the input did not change since the last dispatch
+  *         and no deadline has expired, since no state machine could move.
+  * @param  button: Pointer to the bits button object.
+  * @param  new_mask: Debounced button mask.
+  * @retval None
+  */
+static void dispatch_buttons(bits_button_t *button, button_mask_type_t new_mask)
+{
+    if (new_mask == button->dispatched_mask &&
+        !(button->has_due && __is_deadline_reached(get_button_tick(), button->next_due)))
+    {
+        return;
+    }
+
+    button->dispatched_mask = new_mask;
+    button->has_due = false;
+
+    button_mask_type_t suppressed_mask = 0;
+
+    dispatch_combo_buttons(button, &suppressed_mask);
+
+    dispatch_unsuppressed_buttons(button, suppressed_mask);
+}
+
+/**
+  * @brief  Find a registered combo button by key ID.
+  * @param  button: Pointer to the bits button object.
+  * @param  key_id: Combo key ID.
+  * @retval Position in the priority ordered combo list, or -1 if not registered.
+  */
+static int32_t __find_sorted_combo(bits_button_t *button, uint16_t key_id)
+{
+    for (uint16_t i = 0; i < button->btns_combo_cnt; i++)
+    {
+        if (button->combo_sorted[i]->btn.key_id == key_id)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+  * @brief  Clear the gesture state of a combo button entering or leaving the combo list.
+  * @param  combo: Pointer to the combo button.
+  * @retval None
+  */
+static void __reset_combo_state(button_obj_combo_t *combo)
+{
+    combo->btn.current_state = BTN_STATE_IDLE;
+    combo->btn.last_state = BTN_STATE_IDLE;
+    combo->btn.state_bits = 0;
+    combo->btn.history_chunks = 0;
+    combo->btn.long_press_period_trigger_cnt = 0;
+}
+
+/**
+  * @brief  Rebuild the per-combo tables that follow the combo list order.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __refresh_combo_tables(bits_button_t *button)
+{
+    memset(button->combo_active_bits, 0, sizeof(button->combo_active_bits));
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    button->combo_member_mask = 0;
+#endif
+
+    for (uint16_t i = 0; i < button->btns_combo_cnt; i++)
+    {
+        const button_obj_combo_t *combo = button->combo_sorted[i];
+
+        if (combo->btn.current_state != BTN_STATE_IDLE || combo->btn.state_bits)
+            button->combo_active_bits[i >> 5] |= (uint32_t)1UL << (i & 31);
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+        if (combo->suppress)
+            button->combo_member_mask |= combo->combo_mask;
+#endif
+    }
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    // Keys that no longer belong to any combo stop waiting
+    __take_deferred_events(button, button->deferred_mask & ~button->combo_member_mask, true);
+#endif
+}
+
+/**
+  * @brief  Resolve the single or combo button a queued change refers to.
+  * @param  button: Pointer to the bits button object.
+  * @param  key_id: Key ID of a single or registered combo button.
+  * @retval Pointer to the button object, NULL if the key ID is not registered.
+  */
+static button_obj_t *__find_config_target(bits_button_t *button, uint16_t key_id)
+{
+    int32_t pos = _get_btn_index_by_key_id(key_id);
+
+    if (pos >= 0)
+        return &button->btns[pos];
+
+    pos = __find_sorted_combo(button, key_id);
+    if (pos >= 0)
+        return &button->combo_sorted[pos]->btn;
+
+    return NULL;
+}
+
+/**
+  * @brief  Give the keymap entries without their own parameters the new parameters of a button.
+  * @param  button: Pointer to the bits button object.
+  * @param  btn: Button whose parameters change.
+  * @param  param_index: Compiled parameter index of the new parameters.
+  * @retval true if the current gesture of the button runs on its own parameters, false if
+  *         it latched a layer with parameters of its own.
+  */
+static uint8_t __set_keymap_own_param(bits_button_t *button, button_obj_t *btn, uint8_t param_index)
+{
+    if (button->layer_cnt == 0 || btn < button->btns || btn >= button->btns + button->btns_cnt)
+        return true;
+
+    uint16_t btn_index = (uint16_t)(btn - button->btns);
+
+    for (uint8_t layer = 0; layer < button->layer_cnt; layer++)
+    {
+        uint16_t map_index = layer * button->btns_cnt + btn_index;
+
+        if (bits_btn_keymap[map_index].param == NULL)
+            button->keymap_param_index[map_index] = param_index;
+    }
+
+    return bits_btn_keymap[btn->layer * button->btns_cnt + btn_index].param == NULL;
+}
+
+/**
+  * @brief  Apply the configuration changes queued since the previous tick.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __apply_config_changes(bits_button_t *button)
+{
+    uint16_t read_idx = BITS_BTN_CONFIG_LOAD(bits_btn_config_read_idx);
+    uint16_t write_idx = BITS_BTN_CONFIG_LOAD(bits_btn_config_write_idx);
+    button_obj_t *btn;
+    uint8_t param_index;
+    int32_t pos;
+
+    if (read_idx == write_idx)
+        return;
+
+    while (read_idx != write_idx)
+    {
+        const bits_btn_config_op_t *op = &bits_btn_config_ops[read_idx];
+
+        switch (op->type)
+        {
+            case BITS_BTN_CONFIG_ADD_COMBO:
+                if (button->btns_combo_cnt < BITS_BTN_MAX_COMBO_BUTTONS)
+                {
+                    op->combo->combo_mask = op->combo_mask;
+                    __bind_button_param(button, &op->combo->btn);
+                    __reset_combo_state(op->combo);
+                    __insert_sorted_combo(button, op->combo);
+                }
+                break;
+            case BITS_BTN_CONFIG_REMOVE_COMBO:
+                pos = __find_sorted_combo(button, op->key_id);
+                if (pos >= 0)
+                {
+                    __reset_combo_state(button->combo_sorted[pos]);
+                    button->btns_combo_cnt--;
+                    for (uint16_t i = (uint16_t)pos; i < button->btns_combo_cnt; i++)
+                    {
+                        button->combo_sorted[i] = button->combo_sorted[i + 1];
+                        button->combo_masks[i] = button->combo_masks[i + 1];
+                    }
+                }
+                break;
+            case BITS_BTN_CONFIG_SET_PARAM:
+                btn = __find_config_target(button, op->key_id);
+                param_index = __compile_param(button, op->param);
+                if (btn != NULL && param_index != BITS_BTN_INVALID_PARAM_INDEX)
+                {
+                    btn->param = op->param;
+                    if (__set_keymap_own_param(button, btn, param_index))
+                        btn->param_index = param_index;
+                }
+                break;
+            case BITS_BTN_CONFIG_SET_ENABLED:
+                pos = _get_btn_index_by_key_id(op->key_id);
+                if (pos < 0)
+                    break;
+                if (op->value)
+                    button->enabled_mask |= (button_mask_type_t)1UL << pos;
+                else
+                    button->enabled_mask &= ~((button_mask_type_t)1UL << pos);
+                break;
+            default:
+                break;
+        }
+
+        read_idx = (read_idx + 1) % BITS_BTN_CONFIG_QUEUE_SIZE;
+    }
+
+    BITS_BTN_CONFIG_STORE(bits_btn_config_read_idx, read_idx);
+
+    __refresh_combo_tables(button);
+
+    // Suppression and bindings may have changed: dispatch on this tick even if the input did not
+    button->next_due = get_button_tick();
+    button->has_due = true;
+}
+
+/**
+  * @brief  Queue a configuration change for the next tick.
+  * @param  op: Change to queue.
+  * @retval 0 if queued, -7 if the queue is full.
+  */
+static int32_t __queue_config_change(const bits_btn_config_op_t *op)
+{
+    uint16_t write_idx = BITS_BTN_CONFIG_LOAD(bits_btn_config_write_idx);
+    uint16_t next_write = (write_idx + 1) % BITS_BTN_CONFIG_QUEUE_SIZE;
+
+    if (next_write == BITS_BTN_CONFIG_LOAD(bits_btn_config_read_idx))
+        return -7;
+
+    bits_btn_config_ops[write_idx] = *op;
+    BITS_BTN_CONFIG_STORE(bits_btn_config_write_idx, next_write);
+
+    return 0;
+}
+
+/**
+  * @brief  Find a combo key ID in the producer-side combo list, queued changes included.
+  * @param  key_id: Combo key ID.
+  * @retval Position in bits_btn_config_combo_ids, or -1 if not registered.
+  */
+static int32_t __find_config_combo(uint16_t key_id)
+{
+    for (uint16_t i = 0; i < bits_btn_config_combo_cnt; i++)
+    {
+        if (bits_btn_config_combo_ids[i] == key_id)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+  * @brief  Find a parameter set in the producer-side parameter table, queued changes included.
+  * @param  param: Parameter set, may be NULL.
+  * @retval true if the tick already compiled it or will find it compiled, or `param` is NULL.
+  */
+static uint8_t __find_config_param(const bits_btn_obj_param_t *param)
+{
+    if (param == NULL)
+        return true;
+
+    for (uint8_t i = 0; i < bits_btn_config_params_cnt; i++)
+    {
+        if (bits_btn_config_params[i] == param)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+  * @brief  Queue a change that may bring a new parameter set, reserving its table entry.
+  * @param  op: Change to queue.
+  * @param  param: Parameter set the tick compiles when applying the change, may be NULL.
+  * @retval 0 if queued, -5 if the compiled parameter table would overflow, -7 if the queue is full.
+  */
+static int32_t __queue_config_param_change(const bits_btn_config_op_t *op, const bits_btn_obj_param_t *param)
+{
+    uint8_t known = __find_config_param(param);
+    int32_t ret;
+
+    if (!known && bits_btn_config_params_cnt >= BITS_BTN_MAX_PARAM_SETS)
+        return -5;
+
+    ret = __queue_config_change(op);
+    if (ret == 0 && !known)
+        bits_btn_config_params[bits_btn_config_params_cnt++] = param;
+
+    return ret;
+}
+
+int32_t bits_button_add_combo(button_obj_combo_t *combo)
+{
+    bits_btn_config_op_t op = {0};
+    int32_t ret;
+
+    if (!__engine_ready())
+        return -4;
+
+    if (combo == NULL || combo->key_count == 0 || combo->key_single_ids == NULL)
+        return -2;
+
+    // Also rejects a combo whose addition is still queued
+    if (__find_config_combo(combo->btn.key_id) >= 0)
+        return -1;
+
+    if (bits_btn_config_combo_cnt >= BITS_BTN_MAX_COMBO_BUTTONS)
+        return -3;
+
+    // The combo may still be in the tick's list until a queued removal is applied,
+    // so the mask is handed over with the change instead of written into the combo
+    for (uint16_t i = 0; i < combo->key_count; i++)
+    {
+        int idx = _get_btn_index_by_key_id(combo->key_single_ids[i]);
+        if (idx == -1)
+            return -1;
+        op.combo_mask |= ((button_mask_type_t)1UL << idx);
+    }
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    // Priority keys never reach the combo evaluation; the mask is fixed by bits_button_init()
+    if (op.combo_mask & bits_btn_entity.priority_mask)
+        return -2;
+#endif
+
+    op.type = BITS_BTN_CONFIG_ADD_COMBO;
+    op.key_id = combo->btn.key_id;
+    op.combo = combo;
+
+    ret = __queue_config_param_change(&op, combo->btn.param);
+    if (ret == 0)
+        bits_btn_config_combo_ids[bits_btn_config_combo_cnt++] = combo->btn.key_id;
+
+    return ret;
+}
+
+int32_t bits_button_remove_combo(uint16_t combo_key_id)
+{
+    bits_btn_config_op_t op = {0};
+    int32_t pos = __find_config_combo(combo_key_id);
+    int32_t ret;
+
+    if (!__engine_ready())
+        return -4;
+
+    if (pos < 0)
+        return -1;
+
+    op.type = BITS_BTN_CONFIG_REMOVE_COMBO;
+    op.key_id = combo_key_id;
+
+    ret = __queue_config_change(&op);
+    if (ret == 0)
+    {
+        bits_btn_config_combo_cnt--;
+        for (uint16_t i = (uint16_t)pos; i < bits_btn_config_combo_cnt; i++)
+            bits_btn_config_combo_ids[i] = bits_btn_config_combo_ids[i + 1];
+    }
+
+    return ret;
+}
+
+int32_t bits_button_set_param(uint16_t key_id, const bits_btn_obj_param_t *param)
+{
+    bits_btn_config_op_t op = {0};
+
+    if (!__engine_ready())
+        return -4;
+
+    if (param == NULL)
+        return -2;
+
+    if (_get_btn_index_by_key_id(key_id) < 0 && __find_config_combo(key_id) < 0)
+        return -1;
+
+    op.type = BITS_BTN_CONFIG_SET_PARAM;
+    op.key_id = key_id;
+    op.param = param;
+
+    return __queue_config_param_change(&op, param);
+}
+
+int32_t bits_button_set_key_enabled(uint16_t key_id, uint8_t enabled)
+{
+    bits_btn_config_op_t op = {0};
+
+    if (!__engine_ready())
+        return -4;
+
+    if (_get_btn_index_by_key_id(key_id) < 0)
+        return -1;
+
+    op.type = BITS_BTN_CONFIG_SET_ENABLED;
+    op.key_id = key_id;
+    op.value = enabled ? true : false;
+
+    return __queue_config_change(&op);
+}
+
+/**
+  * @brief  Check whether user callbacks, including debug output, are deferred to bits_button_process().
+  * @retval true in deferred callback mode.
+  */
+static uint8_t __callbacks_deferred(void)
+{
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    return bits_btn_deferred_callbacks;
+#else
+    return false;
+#endif
+}
+
+#ifndef BITS_BTN_DISABLE_SNAPSHOT
+/**
+  * @brief  Publish the key state for bits_button_get_snapshot().
+  * @param  button: Pointer to the bits button object.
+  * @retval None
+  */
+static void __publish_snapshot(bits_button_t *button)
+{
+    bits_btn_snapshot_t *snapshot = &bits_btn_snapshot;
+    uint16_t seq = (uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_snapshot_seq);
+    button_mask_type_t priority_pressed = 0;
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    priority_pressed = button->priority_pressed_mask;
+#endif
+
+    BITS_BTN_CONFIG_STORE(bits_btn_snapshot_seq, (uint16_t)(seq + 1));
+    BITS_BTN_CONFIG_FENCE();
+
+    snapshot->tick = button->btn_tick;
+    snapshot->pressed_mask = button->dispatched_mask | priority_pressed;
+    snapshot->raw_mask = button->current_mask | priority_pressed;
+    snapshot->btn_cnt = (uint8_t)button->btns_cnt;
+    for (uint16_t i = 0; i < button->btns_cnt; i++)
+        snapshot->states[i] = button->btns[i].current_state;
+
+    BITS_BTN_CONFIG_FENCE();
+    BITS_BTN_CONFIG_STORE(bits_btn_snapshot_seq, (uint16_t)(seq + 2));
+}
+#endif
+
+/**
+  * @brief  Debounce one raw sample of the keys and run everything that follows from it:
+  *         state machine dispatch, held back combo term and dual-role events.
+  * @param  button: Pointer to the bits button object.
+  * @param  new_mask: Raw mask of the enabled, non-priority keys, sampled at the current time.
+  * @retval None
+  */
+static void __process_button_mask(bits_button_t *button, button_mask_type_t new_mask)
+{
+    uint32_t current_time = get_button_tick();
+    button_mask_type_t eager_mask = 0;
+
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+    new_mask = __filter_eager_keys(button, new_mask);
+    eager_mask = button->eager_mask;
+#endif
+
+    button->current_mask = new_mask;
+
+    // State synchronization and debounce processing
+    if(button->last_mask != new_mask)
+    {
+        button_mask_type_t changed_mask = (button->last_mask ^ new_mask) & ~eager_mask;
+
+        // Eager keys are already debounced, only the other keys restart the debounce window
+        if (changed_mask)
+        {
+            button->debounce_deadline = current_time + ((changed_mask & new_mask) ? button->press_debounce_time
+                                                                                  : button->release_debounce_time);
+            button->debounce_pending = true;
+        }
+        if(debug_printf && !__callbacks_deferred())
+            debug_printf("NEW MASK %d\n", new_mask);
+        button->last_mask = new_mask;
+    }
+
+    // Only an armed deadline is compared: one left from long ago may look like the future
+    if(!button->debounce_pending || __is_deadline_reached(current_time, button->debounce_deadline))
+    {
+        button->debounce_pending = false;
+        dispatch_buttons(button, new_mask);
+    }
+    else if ((new_mask ^ button->dispatched_mask) & eager_mask)
+    {
+        // An eager edge does not wait for other keys to settle
+        dispatch_buttons(button, (button->dispatched_mask & ~eager_mask) | (new_mask & eager_mask));
+    }
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    __release_deferred_events(button);
+#endif
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    __resolve_dual_roles(button);
+#endif
+
+#ifndef BITS_BTN_DISABLE_SNAPSHOT
+    __publish_snapshot(button);
+#endif
+}
+
+void bits_button_notify_change(void)
+{
+    BITS_BTN_CONFIG_STORE(bits_btn_change_pending, 1);
+}
+
+void bits_button_enable_change_notification(uint8_t enabled)
+{
+    bits_btn_change_notification_enabled = enabled;
+    BITS_BTN_CONFIG_STORE(bits_btn_change_pending, 1);
+}
+
+/**
+  * @brief  Check whether a tick can skip reading the keys: no pin change was notified, no key
+  *         is pressed, and no deadline or configuration change is pending.
+  * @param  button: Pointer to the bits button object.
+  * @retval true if nothing can happen until the next pin change.
+  */
+static uint8_t __can_skip_scan(bits_button_t *button)
+{
+    uint32_t deadline;
+
+    if (BITS_BTN_CONFIG_LOAD(bits_btn_change_pending))
+    {
+        // Cleared before the keys are read, so a change notified meanwhile is read next tick
+        BITS_BTN_CONFIG_STORE(bits_btn_change_pending, 0);
+        return false;
+    }
+
+    if (button->last_mask != 0 ||
+        BITS_BTN_CONFIG_LOAD(bits_btn_config_read_idx) != BITS_BTN_CONFIG_LOAD(bits_btn_config_write_idx))
+        return false;
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    if (button->priority_pressed_mask != 0)
+        return false;
+#endif
+
+    return !bits_button_get_next_deadline(&deadline);
+}
+
+/**
+  * @brief  Run one tick: advance the time, read the keys and dispatch.
+  * @param  button: Pointer to the bits button object.
+  * @retval None
   */
-static uint8_t __check_if_the_bits_match(const key_value_type_t *state_bits, key_value_type_t target, uint8_t target_bits_number)
+static void __run_tick(bits_button_t *button)
 {
-    key_value_type_t mask = (1 << target_bits_number) - 1;
+    if (bits_btn_time_func != NULL)
+        button->btn_tick = bits_btn_time_func();
+    else
+        button->btn_tick++;
 
-    return (((*state_bits) & mask) == target? 1 : 0);
-}
+    __apply_pending_reset(button);
 
-#if 0
-uint8_t check_is_repeat_click_mode(struct button_obj_t* button)
-{
-    key_value_type_t kv_input = button->key_value;
+    if (bits_btn_change_notification_enabled && __can_skip_scan(button))
+        return;
 
-    /* Check if the two least significant bits form 0b10 */
-    if((kv_input & 0b11) != 0b10)
-        return 0;
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    // Priority keys first, so their latency does not depend on the rest of the keypad
+    __process_priority_keys(button, NULL);
+#endif
 
-    /* Calculate the XOR result */
-    key_value_type_t xor_result = kv_input ^ (kv_input >> 1);
+    __apply_config_changes(button);
 
-    /* Check if xor_result + 1 is a power of 2
-       This means all bits except the least significant one are 1 */
-    return (xor_result != 0) && (((xor_result + 1) & (xor_result - 1)) == 0);
+    __process_button_mask(button, __read_button_mask(button));
 }
-#endif
 
 /**
-  * @brief  Report a button event.
-  * @param  button: Pointer to the button object.
-  * @param  result: Pointer to the button result to be reported.
+  * @brief  Publish the tick statistics for bits_button_get_tick_stats().
   * @retval None
   */
-static void bits_btn_report_event(struct button_obj_t* button, bits_btn_result_t *result)
+static void __publish_tick_stats(void)
 {
-    bits_btn_result_callback btn_result_cb = bits_btn_entity.bits_btn_result_cb;
+    uint16_t seq = (uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_tick_stats_seq);
 
-    if(result == NULL) return;
+    BITS_BTN_CONFIG_STORE(bits_btn_tick_stats_seq, (uint16_t)(seq + 1));
+    BITS_BTN_CONFIG_FENCE();
 
-    if(debug_printf)
-        debug_printf("key id[%d],event:%d, long trigger_cnt:%d, key_value:", result->key_id, result->event ,result->long_press_period_trigger_cnt);
-    debug_print_binary(result->key_value);
+    bits_btn_tick_stats_published = bits_btn_tick_stats;
 
-#ifndef BITS_BTN_DISABLE_BUFFER
-    uint8_t is_user_result_filter_exist = (bits_btn_result_user_filter_cb != NULL);
-    uint8_t default_result_filter_triger = (result->event == BTN_STATE_LONG_PRESS) || (result->event == BTN_STATE_FINISH);
+    BITS_BTN_CONFIG_FENCE();
+    BITS_BTN_CONFIG_STORE(bits_btn_tick_stats_seq, (uint16_t)(seq + 2));
+}
 
-    if (bits_btn_buffer_ops && bits_btn_buffer_ops->write)
+void bits_button_ticks(void)
+{
+    bits_btn_get_time_func cycle_counter = bits_btn_cycle_counter;
+    uint32_t start = cycle_counter ? cycle_counter() : 0;
+
+    if (BITS_BTN_CONFIG_LOAD(bits_btn_tick_stats_reset))
     {
-        uint8_t should_write_to_buffer = 0;
+        BITS_BTN_CONFIG_STORE(bits_btn_tick_stats_reset, 0);
+        memset(&bits_btn_tick_stats, 0, sizeof(bits_btn_tick_stats));
+    }
 
-        if (is_user_result_filter_exist)
-        {
-            should_write_to_buffer = bits_btn_result_user_filter_cb(*result);
-        }
-        else
-        {
-            should_write_to_buffer = default_result_filter_triger;
-        }
+    bits_btn_tick_event_cnt = 0;
 
-        if (should_write_to_buffer)
-        {
-            bits_btn_buffer_ops->write(result);
-        }
-    }
+    __run_tick(&bits_btn_entity);
+
+#if BITS_BTN_BATCH_SIZE > 0
+    __flush_tick_batch();
 #endif
 
-    if(btn_result_cb)
-        btn_result_cb(button, *result);
+    bits_btn_tick_stats.ticks++;
+    if (bits_btn_tick_event_cnt > bits_btn_tick_stats.max_events_per_tick)
+        bits_btn_tick_stats.max_events_per_tick = bits_btn_tick_event_cnt;
+
+    if (cycle_counter)
+    {
+        bits_btn_tick_stats.last_cycles = cycle_counter() - start;
+        if (bits_btn_tick_stats.last_cycles > bits_btn_tick_stats.max_cycles)
+            bits_btn_tick_stats.max_cycles = bits_btn_tick_stats.last_cycles;
+    }
 
+    __publish_tick_stats();
 }
 
-/**
-  * @brief  Update the button state machine.
-  * @param  button: Pointer to the button object.
-  * @param  btn_pressed: Flag indicating whether the button is pressed.
-  * @retval None
-  */
-static void update_button_state_machine(struct button_obj_t* button, uint8_t btn_pressed)
+void bits_button_set_context(void *context)
 {
-    uint32_t current_time = get_button_tick();
-    uint32_t time_diff = current_time - button->state_entry_time;
-    bits_btn_result_t result = {0};
-    result.key_id = button->key_id;
+    bits_btn_context = context;
+}
 
-    if(button->param == NULL)
-        return;
+void *bits_button_get_context(void)
+{
+    return bits_btn_context;
+}
 
-    switch (button->current_state)
+void bits_button_set_deferred_callbacks(uint8_t enabled)
+{
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    bits_btn_deferred_callbacks = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+uint16_t bits_button_process(void)
+{
+    uint16_t handled = 0;
+
+#if BITS_BTN_EVENT_QUEUE_SIZE > 0
+    uint16_t read_idx = BITS_BTN_CONFIG_LOAD(bits_btn_event_read_idx);
+
+    while (read_idx != BITS_BTN_CONFIG_LOAD(bits_btn_event_write_idx))
     {
-        case BTN_STATE_IDLE:
-            if (btn_pressed)
-            {
-                __append_bit(&button->state_bits, 1);
+        bits_btn_deferred_event_t entry = bits_btn_event_queue[read_idx];
 
-                button->current_state = BTN_STATE_PRESSED;
-                button->state_entry_time = current_time;
+        read_idx = (read_idx + 1) % BITS_BTN_EVENT_QUEUE_SIZE;
+        BITS_BTN_CONFIG_STORE(bits_btn_event_read_idx, read_idx);
 
-                result.key_value = button->state_bits;
-                result.event = button->current_state;
-                bits_btn_report_event(button, &result);
-            }
-            break;
-        case BTN_STATE_PRESSED:
-            if (time_diff * BITS_BTN_TICKS_INTERVAL > button->param->long_press_start_time_ms)
-            {
-                __append_bit(&button->state_bits, 1);
+        // Queued before the last reset took effect: the gesture no longer exists
+        if (__is_stale_result(&entry.result))
+            continue;
 
-                button->current_state = BTN_STATE_LONG_PRESS;
-                button->state_entry_time = current_time;
-                button->long_press_period_trigger_cnt = 0;
+        __run_event_callbacks(entry.btn, &entry.result);
+        handled++;
+    }
+#endif
 
-                result.key_value = button->state_bits;
-                result.event = button->current_state;
-                bits_btn_report_event(button, &result);
-            }
-            else if (btn_pressed == 0)
-            {
-                button->current_state = BTN_STATE_RELEASE;
-            }
-            break;
-        case BTN_STATE_LONG_PRESS:
-            if (btn_pressed == 0)
-            {
-                button->long_press_period_trigger_cnt = 0;
-                button->current_state = BTN_STATE_RELEASE;
-            }
-            else if(time_diff * BITS_BTN_TICKS_INTERVAL > button->param->long_press_period_triger_ms)
-            {
-                button->state_entry_time = current_time;
-                button->long_press_period_trigger_cnt++;
+#if BITS_BTN_BATCH_SIZE > 0
+    __flush_batch();
+#endif
 
-                if(__check_if_the_bits_match(&button->state_bits, 0b011, 3))
-                {
-                    __append_bit(&button->state_bits, 1);
-                }
+    return handled;
+}
 
-                result.key_value = button->state_bits;
-                result.event = button->current_state;
-                result.long_press_period_trigger_cnt = button->long_press_period_trigger_cnt;
-                bits_btn_report_event(button, &result);
-            }
-            break;
-        case BTN_STATE_RELEASE:
-            __append_bit(&button->state_bits, 0);
+void bits_button_set_batch_callback(bits_btn_batch_callback batch_cb)
+{
+#if BITS_BTN_BATCH_SIZE > 0
+    bits_btn_batch_cb = batch_cb;
+    bits_btn_batch_cnt = 0;
+    bits_btn_batch_combo_cnt = 0;
+#else
+    (void)batch_cb;
+#endif
+}
 
-            result.key_value = button->state_bits;
-            result.event = BTN_STATE_RELEASE;
-            bits_btn_report_event(button, &result);
+void bits_button_set_cycle_counter(bits_btn_get_time_func cycle_counter)
+{
+    bits_btn_cycle_counter = cycle_counter;
+}
 
-            button->current_state = BTN_STATE_RELEASE_WINDOW;
-            button->state_entry_time = current_time;
+uint8_t bits_button_get_tick_stats(bits_btn_tick_stats_t *stats)
+{
+    if (stats == NULL)
+        return 0;
 
-            break;
-        case BTN_STATE_RELEASE_WINDOW:
-            if (btn_pressed)
-            {
-                button->current_state = BTN_STATE_IDLE;
-                button->state_entry_time = current_time;
-            }
-            else if (time_diff * BITS_BTN_TICKS_INTERVAL > button->param->time_window_time_ms)
-            {
-                // Time window timeout, trigger event and return to idle
-                button->current_state = BTN_STATE_FINISH;
-            }
-            break;
-        case BTN_STATE_FINISH:
+    // Bounded, so a reader that interrupted the publishing tick cannot spin forever
+    for (uint8_t attempt = 0; attempt < 3; attempt++)
+    {
+        uint16_t seq = (uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_tick_stats_seq);
 
-            result.key_value = button->state_bits;
-            result.event = BTN_STATE_FINISH;
-            bits_btn_report_event(button, &result);
+        if (seq & 1)
+            continue;
 
-            button->state_bits = 0;
-            button->current_state = BTN_STATE_IDLE;
-            break;
-        default:
-            break;
+        BITS_BTN_CONFIG_FENCE();
+        *stats = bits_btn_tick_stats_published;
+        BITS_BTN_CONFIG_FENCE();
 
+        if ((uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_tick_stats_seq) == seq)
+            return 1;
     }
 
-    if(button->last_state != button->current_state)
-    {
-#if 0
-        if(debug_printf)
-            debug_printf("id[%d]:cur status:%d,last:%d\n", button->key_id, button->current_state, button->last_state);
-#endif
-        button->last_state = button->current_state;
-    }
+    return 0;
 }
 
-/**
-  * @brief  Handle the button state based on the current mask and button mask.
-  * @param  button: Pointer to the button object.
-  * @param  current_mask: The current button mask.
-  * @param  btn_mask: The button mask of the specific button.
-  * @retval None
-  */
-static void handle_button_state(struct button_obj_t* button, button_mask_type_t current_mask, button_mask_type_t btn_mask)
+void bits_button_reset_tick_stats(void)
 {
-    uint8_t pressed = (current_mask & btn_mask) == btn_mask? 1 : 0;
-    update_button_state_machine(button, pressed);
+    BITS_BTN_CONFIG_STORE(bits_btn_tick_stats_reset, 1);
 }
 
-/**
-  * @brief  Dispatch and process combo buttons and generate a suppression mask.
-  * @param  button: Pointer to the bits button object.
-  * @param  suppression_mask: Pointer to store the suppression mask.
-  * @retval None
-  */
-static void dispatch_combo_buttons(bits_button_t *button, button_mask_type_t *suppression_mask)
+uint8_t bits_button_get_snapshot(bits_btn_snapshot_t *snapshot)
 {
-    if(button->btns_combo_cnt == 0) return;
-
-    button_mask_type_t activated_mask = 0;
+#ifndef BITS_BTN_DISABLE_SNAPSHOT
+    if (!__engine_ready())
+        return 0;
 
-    for (uint16_t i = 0; i < button->btns_combo_cnt; i++)
+    // Bounded, so a reader that interrupted the publishing tick cannot spin forever
+    for (uint8_t attempt = 0; attempt < 3; attempt++)
     {
-        uint16_t combo_index = button->combo_sorted_indices[i];
-        button_obj_combo_t* combo = &button->btns_combo[combo_index];
-        button_mask_type_t combo_mask = combo->combo_mask;
+        uint16_t seq = (uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_snapshot_seq);
 
-        // Check if the current combo button is covered by a more specific combo button
-        if (activated_mask & combo_mask)
-        {
-            // Already covered, skip processing
+        if (seq & 1)
             continue;
-        }
 
-        // Handle state transitions for this combo button
-        handle_button_state(&combo->btn, button->current_mask, combo_mask);
+        BITS_BTN_CONFIG_FENCE();
+        *snapshot = bits_btn_snapshot;
+        BITS_BTN_CONFIG_FENCE();
 
-        if ((button->current_mask & combo_mask) == combo_mask || combo->btn.state_bits)
-        {
-            // Mark the current combo button as activated
-            activated_mask |= combo_mask;
-
-            if (combo->suppress)
-            {
-                *suppression_mask |= combo_mask;
-            }
-        }
+        if ((uint16_t)BITS_BTN_CONFIG_LOAD(bits_btn_snapshot_seq) == seq)
+            return 1;
     }
+#else
+    (void)snapshot;
+#endif
+    return 0;
 }
 
 /**
-  * @brief  Dispatch and process unsuppressed individual buttons.
+  * @brief  Process one sample of a batch at its sample time.
   * @param  button: Pointer to the bits button object.
-  * @param  suppression_mask: The suppression mask.
+  * @param  sample_time: Time of the sample; the engine time never moves backwards.
+  * @param  sample: Raw sample of the port, one bit per single button.
   * @retval None
   */
-static void dispatch_unsuppressed_buttons(bits_button_t *button, button_mask_type_t suppression_mask)
+static void __feed_sample(bits_button_t *button, uint32_t sample_time, button_mask_type_t sample)
 {
-    // ​​Process Unsuppressed Individual Buttons
-    for (size_t i = 0; i < button->btns_cnt; i++)
-    {
-        button_mask_type_t btn_mask = ((button_mask_type_t)1UL << i);
+    button_mask_type_t keys_mask = button->enabled_mask;
 
-        // Skip individual buttons suppressed by combo buttons
-        if (suppression_mask & btn_mask) {
-            continue;
-        }
+    if ((int32_t)(sample_time - button->btn_tick) > 0)
+        button->btn_tick = sample_time;
 
-        handle_button_state(&button->btns[i], button->current_mask, btn_mask);
-    }
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    __process_priority_keys(button, &sample);
+    keys_mask &= ~button->priority_mask;
+#endif
+
+    if (button->btns_cnt < BITS_BTN_MAX_KEYS)
+        keys_mask &= ((button_mask_type_t)1UL << button->btns_cnt) - 1;
+
+    __process_button_mask(button, sample & keys_mask);
 }
 
-void bits_button_ticks(void)
+int32_t bits_button_feed_samples(const button_mask_type_t *masks, size_t n, uint32_t sample_period)
 {
     bits_button_t *button = &bits_btn_entity;
-    uint32_t current_time = get_button_tick();
+    uint32_t sample_time;
+    size_t i = 0;
 
-    button->btn_tick++;
+    // A period below one engine time unit cannot be represented, see the header
+    if (masks == NULL || sample_period == 0)
+        return -2;
 
-    // Calculate button index
-    button_mask_type_t new_mask = 0;
-    for(size_t i = 0; i < button->btns_cnt; i++)
+    if (n == 0)
+        return 0;
+
+    // With a time source the batch ends now, otherwise it continues the tick count
+    if (bits_btn_time_func != NULL)
+        sample_time = bits_btn_time_func() - (uint32_t)(n - 1) * sample_period;
+    else
+        sample_time = button->btn_tick + sample_period;
+
+    __apply_pending_reset(button);
+    __apply_config_changes(button);
+
+    while (i < n)
     {
-        uint8_t read_gpio_level = button->_read_button_level(&button->btns[i]);
+        size_t run_end = i + 1;
 
-        if (read_gpio_level == button->btns[i].active_level)
+        while (run_end < n && masks[run_end] == masks[i])
+            run_end++;
+
+        __feed_sample(button, sample_time, masks[i]);
+        i++;
+        sample_time += sample_period;
+
+        // Identical samples only need processing where a deadline expires
+        while (i < run_end)
         {
-            new_mask |= ((button_mask_type_t)1UL << i);
-        }
-    }
+            uint32_t deadline;
+            uint32_t skip = (uint32_t)(run_end - i);
 
-    button->current_mask = new_mask;
+            if (bits_button_get_next_deadline(&deadline))
+            {
+                uint32_t wait = __is_deadline_reached(sample_time, deadline) ? 0 : deadline - sample_time;
 
-    // State synchronization and debounce processing
-    if(button->last_mask != new_mask)
-    {
-        button->state_entry_time = current_time;
-        if(debug_printf)
-            debug_printf("NEW MASK %d\n", new_mask);
-        button->last_mask = new_mask;
-    }
+                if ((wait + sample_period - 1) / sample_period < skip)
+                    skip = (wait + sample_period - 1) / sample_period;
+            }
 
-    uint32_t time_diff = current_time - button->state_entry_time;
+            if (skip == run_end - i)
+            {
+                // Nothing happens until the next change: only the time moves on
+                sample_time += (skip - 1) * sample_period;
+                if ((int32_t)(sample_time - button->btn_tick) > 0)
+                    button->btn_tick = sample_time;
+                sample_time += sample_period;
+                i = run_end;
+                break;
+            }
 
-    if(time_diff * BITS_BTN_TICKS_INTERVAL  < BITS_BTN_DEBOUNCE_TIME_MS)
-    {
-        return;
+            i += skip;
+            sample_time += skip * sample_period;
+            __feed_sample(button, sample_time, masks[i]);
+            i++;
+            sample_time += sample_period;
+        }
     }
 
-    button_mask_type_t suppressed_mask = 0;
-
-    dispatch_combo_buttons(button, &suppressed_mask);
+#if BITS_BTN_BATCH_SIZE > 0
+    __flush_tick_batch();
+#endif
 
-    dispatch_unsuppressed_buttons(button, suppressed_mask);
+    return 0;
 }
 
 /**
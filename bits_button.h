@@ -12,9 +12,76 @@ extern "C" {
 #define BITS_BTN_MAX_COMBO_BUTTONS  8 // 默认最大支持8个组合按钮
 #endif
 
+#define BITS_BTN_COMBO_BITMAP_WORDS ((BITS_BTN_MAX_COMBO_BUTTONS + 31) / 32)
+
+#ifndef BITS_BTN_CONFIG_QUEUE_SIZE
+#define BITS_BTN_CONFIG_QUEUE_SIZE  8 // 默认最多缓存7个待生效的运行时配置变更
+#endif
+
+#ifndef BITS_BTN_MAX_PARAM_SETS
+#define BITS_BTN_MAX_PARAM_SETS     8 // 默认最多8组不同的按键参数
+#endif
+
+#define BITS_BTN_INVALID_PARAM_INDEX 0xFF
+
+#ifndef BITS_BTN_MAX_SEQUENCE_NODES
+#define BITS_BTN_MAX_SEQUENCE_NODES 16 // 默认按键序列前缀树最多16个节点
+#endif
+
+#if BITS_BTN_MAX_SEQUENCE_NODES > 255
+#error "BITS_BTN_MAX_SEQUENCE_NODES must not exceed 255"
+#endif
+
+#define BITS_BTN_SEQ_NO_MATCH       0xFF
+
+#ifndef BITS_BTN_MAX_LAYERS
+#define BITS_BTN_MAX_LAYERS         4 // 默认最多4个按键映射层
+#endif
+
+#ifndef BITS_BTN_MAX_DUAL_ROLE_KEYS
+#define BITS_BTN_MAX_DUAL_ROLE_KEYS 4 // 默认最多4个单击/长按双功能键, 0 表示不编译该功能
+#endif
+
+#ifndef BITS_BTN_DUAL_ROLE_EVENT_SIZE
+#define BITS_BTN_DUAL_ROLE_EVENT_SIZE 8 // Events held back while a dual-role key is undecided
+#endif
+
+#ifndef BITS_BTN_MAX_PRIORITY_KEYS
+#define BITS_BTN_MAX_PRIORITY_KEYS  2 // 默认最多2个优先按键, 0 表示不编译该功能
+#endif
+
+#ifndef BITS_BTN_EVENT_QUEUE_SIZE
+#define BITS_BTN_EVENT_QUEUE_SIZE   16 // 延迟回调模式的事件队列, 最多缓存15个事件, 0 表示不编译该功能
+#endif
+
+#ifndef BITS_BTN_BATCH_SIZE
+#define BITS_BTN_BATCH_SIZE         16 // 批量回调每次最多收集16个事件, 0 表示不编译该功能
+#endif
+
+#define BITS_BTN_MAX_KEYS           32 // One bit per single button in button_mask_type_t
+
+// Event type bits for bits_btn_set_result_filter_mask()
+#define BITS_BTN_EVENT_BIT(_event)          (1UL << (_event))
+#define BITS_BTN_DEFAULT_EVENT_MASK         (BITS_BTN_EVENT_BIT(BTN_STATE_LONG_PRESS) | BITS_BTN_EVENT_BIT(BTN_STATE_FINISH) | \
+                                             BITS_BTN_EVENT_BIT(BTN_EVENT_HISTORY_OVERFLOW))
+#define BITS_BTN_NO_LAYER           0xFF
+
+// Width of the per-button gesture history (state_bits), 32 or 64 bits.
+#ifndef BITS_BTN_STATE_BITS_WIDTH
+#define BITS_BTN_STATE_BITS_WIDTH   32
+#endif
+
+#if BITS_BTN_STATE_BITS_WIDTH == 64
+typedef uint64_t key_value_type_t;
+typedef uint64_t state_bits_type_t;
+#elif BITS_BTN_STATE_BITS_WIDTH == 32
 typedef uint32_t key_value_type_t;
 typedef uint32_t state_bits_type_t;
-typedef state_bits_type_t button_mask_type_t;
+#else
+#error "BITS_BTN_STATE_BITS_WIDTH must be 32 or 64"
+#endif
+
+typedef uint32_t button_mask_type_t;
 
 
 typedef enum {
@@ -23,7 +90,8 @@ typedef enum {
     BTN_STATE_LONG_PRESS        ,
     BTN_STATE_RELEASE           ,
     BTN_STATE_RELEASE_WINDOW    ,
-    BTN_STATE_FINISH
+    BTN_STATE_FINISH            ,
+    BTN_EVENT_HISTORY_OVERFLOW      // Report-only event, never a button state
 } bits_btn_state_t;
 
 //According to your need to modify the constants.
@@ -35,6 +103,26 @@ typedef enum {
 #define BITS_BTN_DEBOUNCE_TIME_MS            (40)
 #endif
 
+// Asymmetric debounce: a mask change with a new press waits the press time, a change made of
+// releases only waits the release time. For eager keys these are the lockout times after an edge.
+#ifndef BITS_BTN_PRESS_DEBOUNCE_TIME_MS
+#define BITS_BTN_PRESS_DEBOUNCE_TIME_MS      BITS_BTN_DEBOUNCE_TIME_MS
+#endif
+
+#ifndef BITS_BTN_RELEASE_DEBOUNCE_TIME_MS
+#define BITS_BTN_RELEASE_DEBOUNCE_TIME_MS    BITS_BTN_DEBOUNCE_TIME_MS
+#endif
+
+// Combo term: events of keys that belong to a suppressing combo are held back for this long
+// after the key is pressed, and dropped if the combo completes in the meantime. 0 disables it.
+#ifndef BITS_BTN_COMBO_TERM_MS
+#define BITS_BTN_COMBO_TERM_MS               (0)
+#endif
+
+#ifndef BITS_BTN_DEFERRED_EVENT_SIZE
+#define BITS_BTN_DEFERRED_EVENT_SIZE         8 // Events held back during the combo term
+#endif
+
 #define BITS_BTN_SHORT_TIME_MS               (350)
 #define BITS_BTN_LONG_PRESS_START_TIME_MS    (1000)
 #define BITS_BTN_LONG_PRESS_PERIOD_TRIGER_MS (1000)
@@ -64,24 +152,69 @@ typedef enum {
 #define false 0
 #endif
 
-#define BITS_BUTTON_INIT(_key_id, _active_level, _param)                                    \
+#define BITS_BUTTON_INIT_FULL(_key_id, _active_level, _param, _eager_debounce, _user_data)  \
 {                                                                                           \
-    .active_level = _active_level, .current_state = 0, .last_state = 0, .key_id = _key_id,  \
-    .long_press_period_trigger_cnt = 0, .state_entry_time = 0,                              \
-    .state_bits = 0, .param = _param                                                        \
+    .active_level = _active_level, .current_state = 0, .last_state = 0,                     \
+    .eager_debounce = _eager_debounce, .param_index = 0, .key_id = _key_id,                 \
+    .long_press_period_trigger_cnt = 0, .layer = 0, .next_deadline = 0,                     \
+    .state_bits = 0, .param = _param, .user_data = _user_data                               \
 }
 
+#define BITS_BUTTON_INIT_EX(_key_id, _active_level, _param, _eager_debounce)               \
+    BITS_BUTTON_INIT_FULL(_key_id, _active_level, _param, _eager_debounce, NULL)
+
+#define BITS_BUTTON_INIT(_key_id, _active_level, _param)                                    \
+    BITS_BUTTON_INIT_EX(_key_id, _active_level, _param, 0)
+
+// Attach application data to a button, e.g. its GPIO port and pin, read back as btn->user_data
+// in the read and result callbacks instead of switching on key_id.
+#define BITS_BUTTON_INIT_USER(_key_id, _active_level, _param, _user_data)                   \
+    BITS_BUTTON_INIT_FULL(_key_id, _active_level, _param, 0, _user_data)
+
+// Leading-edge debounce: the first edge is reported at once, further edges are ignored
+// for the debounce time. Suits game and jog controls that cannot afford the debounce delay.
+#define BITS_BUTTON_EAGER_INIT(_key_id, _active_level, _param)                              \
+    BITS_BUTTON_INIT_EX(_key_id, _active_level, _param, 1)
+
 #define BITS_BUTTON_COMBO_INIT(_key_id, _active_level, _param, _key_single_ids, _key_count, _single_key_suppress)   \
 {                                                                                                                   \
     .suppress = _single_key_suppress, .key_count = _key_count, .key_single_ids = _key_single_ids, .combo_mask = 0,  \
     .btn = BITS_BUTTON_INIT(_key_id, _active_level, _param)                                                         \
 }
 
+#define BITS_BTN_DUAL_ROLE_INIT(_key_id, _hold_key_id, _hold_time_ms)                          \
+{                                                                                               \
+    .key_id = _key_id, .hold_key_id = _hold_key_id, .hold_time_ms = _hold_time_ms               \
+}
+
+#define BITS_BUTTON_SEQUENCE_INIT(_key_id, _key_single_ids, _key_count, _timeout_ms)              \
+{                                                                                               \
+    .key_count = _key_count, .key_single_ids = _key_single_ids, .timeout_ms = _timeout_ms,      \
+    .btn = BITS_BUTTON_INIT(_key_id, 1, NULL)                                                   \
+}
+
+typedef enum {
+    BITS_BTN_ACTION_NONE        ,
+    BITS_BTN_ACTION_LAYER_TO    ,   // Switch the base layer on press
+    BITS_BTN_ACTION_LAYER_MO        // Activate a layer while the button is held
+} bits_btn_action_t;
+
+#define BITS_BTN_KEYMAP_KEY(_key_id, _param)    { .key_id = _key_id, .action = BITS_BTN_ACTION_NONE, .action_layer = 0, .param = _param }
+#define BITS_BTN_KEYMAP_TO(_key_id, _layer)     { .key_id = _key_id, .action = BITS_BTN_ACTION_LAYER_TO, .action_layer = _layer, .param = NULL }
+#define BITS_BTN_KEYMAP_MO(_key_id, _layer)     { .key_id = _key_id, .action = BITS_BTN_ACTION_LAYER_MO, .action_layer = _layer, .param = NULL }
+
 typedef struct bits_btn_result
 {
     uint8_t event;
+    // Number of BTN_EVENT_HISTORY_OVERFLOW chunks of this gesture reported before this result.
+    // Non-zero means key_value only holds the tail of a longer gesture: the full history is the
+    // concatenation of the chunks (in order) and this key_value, never a short gesture by itself.
+    uint8_t history_chunk;
     uint16_t key_id;
     uint16_t long_press_period_trigger_cnt;
+    // Reset epoch the event was reported in; readers drop events from before the last
+    // bits_button_reset_states().
+    uint8_t reset_epoch;
     state_bits_type_t key_value;
 } bits_btn_result_t;
 
@@ -91,23 +224,73 @@ typedef struct bits_btn_obj_param
     uint16_t long_press_start_time_ms;
     uint16_t long_press_period_triger_ms;
     uint16_t time_window_time_ms;
+    // Optional hold acceleration: each hold event shortens the next period by
+    // long_press_period_step_ms, down to long_press_period_min_ms. 0 keeps the period fixed.
+    uint16_t long_press_period_min_ms;
+    uint16_t long_press_period_step_ms;
 } bits_btn_obj_param_t;
 
+// Button parameters converted to engine time units (ticks, or time source units) by bits_button_init().
+// Each value is the time after state entry at which the state expires.
+typedef struct bits_btn_compiled_param
+{
+    const bits_btn_obj_param_t *param;
+    uint32_t long_press_start_time;
+    uint32_t long_press_period_time;
+    uint32_t long_press_period_min_time;
+    uint32_t long_press_period_step_time;
+    uint32_t time_window_time;
+} bits_btn_compiled_param_t;
+
 typedef struct button_obj_t {
     uint8_t  active_level : 1;
     uint8_t current_state : 3;
     uint8_t last_state : 3;
+    uint8_t eager_debounce : 1;     // Leading-edge debounce, see BITS_BUTTON_EAGER_INIT()
+    uint8_t param_index;            // Slot in the compiled parameter table, assigned by bits_button_init()
     uint16_t  key_id;
     uint16_t long_press_period_trigger_cnt;
-    uint32_t state_entry_time;
+    uint8_t layer;                  // Keymap layer latched when the current gesture started
+    uint8_t history_chunks;         // Overflow chunks reported in the current gesture
+    uint32_t next_deadline;         // Engine time at which the current timed state expires
     state_bits_type_t state_bits;
     const bits_btn_obj_param_t *param;
+    void *user_data;                // Application data, never touched by the engine
 } button_obj_t;
 
+typedef struct bits_btn_deferred_event
+{
+    button_obj_t *btn;
+    bits_btn_result_t result;
+} bits_btn_deferred_event_t;
+
+// Cost of bits_button_ticks(), see bits_button_get_tick_stats().
+typedef struct bits_btn_tick_stats
+{
+    uint32_t ticks;                     // Ticks measured since the last reset
+    uint32_t last_cycles;               // Cost of the last tick, in cycle counter units
+    uint32_t max_cycles;                // Worst cost of a tick
+    uint16_t max_events_per_tick;       // Most events reported by a single tick
+    uint16_t queue_high_water;          // Most events waiting in the deferred callback queue
+    uint32_t dropped_events;            // Events lost because the deferred callback queue was full
+} bits_btn_tick_stats_t;
+
+// Key state published by every tick, see bits_button_get_snapshot().
+typedef struct bits_btn_snapshot
+{
+    uint32_t tick;                      // Engine time of the tick that published the snapshot
+    button_mask_type_t pressed_mask;    // Debounced keys, bit n is the n-th single button
+    button_mask_type_t raw_mask;        // Keys as read by that tick, before debounce
+    uint8_t btn_cnt;                    // Valid entries of states
+    uint8_t states[BITS_BTN_MAX_KEYS];  // bits_btn_state_t of each single button
+} bits_btn_snapshot_t;
+
 typedef uint8_t (*bits_btn_read_button_level)(struct button_obj_t *btn);
 typedef void (*bits_btn_result_callback)(struct button_obj_t *btn, struct bits_btn_result button_result);
 typedef int (*bits_btn_debug_printf_func)(const char*, ...);
 typedef uint8_t (*bits_btn_result_user_filter_callback)(bits_btn_result_t button_result);
+typedef uint32_t (*bits_btn_get_time_func)(void);
+typedef void (*bits_btn_batch_callback)(const bits_btn_result_t *events, size_t n);
 
 typedef struct button_obj_combo
 {
@@ -119,6 +302,62 @@ typedef struct button_obj_combo
     button_obj_t btn;
 } button_obj_combo_t;
 
+// Meaning of one single button in one layer. A keymap is a flat array of
+// layer_cnt * btns_cnt entries, indexed by layer * btns_cnt + button index.
+typedef struct bits_btn_keymap_entry
+{
+    uint16_t key_id;                    // Key ID reported for gestures started in this layer
+    uint8_t action;                     // bits_btn_action_t
+    uint8_t action_layer;
+    const bits_btn_obj_param_t *param;  // NULL keeps the parameters of the button object
+} bits_btn_keymap_entry_t;
+
+// Tap-hold key: a single button that reports its own key ID when tapped and hold_key_id when
+// held. The role is decided per gesture, as soon as it is certain: releasing the key first is a
+// tap; holding it for hold_time_ms, or pressing and releasing another key meanwhile, is a hold.
+typedef struct bits_btn_dual_role
+{
+    uint16_t key_id;                    // Key ID of the single button
+    uint16_t hold_key_id;               // Key ID reported for the events of a held gesture
+    uint16_t hold_time_ms;
+} bits_btn_dual_role_t;
+
+// Priority key: a single button sampled and reported first in every tick, with its own press and
+// release debounce (0 reports on the first sample). It bypasses the global debounce, combos and
+// the gesture state machine, and only reports BTN_STATE_PRESSED and BTN_STATE_RELEASE.
+typedef struct bits_btn_priority_key
+{
+    uint16_t key_id;
+    uint16_t press_debounce_ms;
+    uint16_t release_debounce_ms;
+} bits_btn_priority_key_t;
+
+#define BITS_BTN_PRIORITY_KEY_INIT(_key_id, _press_debounce_ms, _release_debounce_ms)            \
+{                                                                                               \
+    .key_id = _key_id, .press_debounce_ms = _press_debounce_ms,                                 \
+    .release_debounce_ms = _release_debounce_ms                                                 \
+}
+
+// Ordered presses of single buttons, e.g. "A then B then A". A match is reported as a
+// BTN_STATE_FINISH event with the key_id of `btn`.
+typedef struct bits_btn_sequence
+{
+    uint8_t key_count;
+    uint16_t *key_single_ids;
+    uint16_t timeout_ms;                // Maximum time between two consecutive presses
+    button_obj_t btn;
+} bits_btn_sequence_t;
+
+// Sequence trie node. The children of a node are stored contiguously in button index order,
+// so the next node is found from child_mask with a single bit count.
+typedef struct bits_btn_seq_node
+{
+    button_mask_type_t child_mask;
+    uint8_t first_child;
+    uint8_t match;                      // Index of the sequence completed here, or BITS_BTN_SEQ_NO_MATCH
+    uint32_t timeout_time;              // Time allowed to reach the next step, in engine time units
+} bits_btn_seq_node_t;
+
 typedef struct bits_button
 {
     button_obj_t *btns;
@@ -128,12 +367,76 @@ typedef struct bits_button
 
     button_mask_type_t current_mask;
     button_mask_type_t last_mask;
-    uint32_t state_entry_time;
+    button_mask_type_t enabled_mask;            // Disabled keys always read as released
+    button_mask_type_t dispatched_mask;         // Debounced mask seen by the last state machine dispatch
+    button_mask_type_t active_mask;             // Single buttons whose state machine is not idle
+    uint32_t next_due;                          // Earliest deadline among the buttons processed by the last dispatch
+    uint8_t has_due;
+    uint32_t debounce_deadline;
+    uint8_t debounce_pending;                   // debounce_deadline is armed; stale deadlines are never compared
+    uint32_t press_debounce_time;
+    uint32_t release_debounce_time;
+#ifndef BITS_BTN_DISABLE_EAGER_DEBOUNCE
+    button_mask_type_t eager_mask;              // Single buttons using leading-edge debounce
+    button_mask_type_t eager_level_mask;        // Level accepted for the eager keys
+    button_mask_type_t eager_locked_mask;       // Eager keys ignoring edges until their lockout ends
+    uint32_t eager_lock_deadline[BITS_BTN_MAX_KEYS];
+#endif
     uint32_t btn_tick;
     bits_btn_read_button_level _read_button_level;
     bits_btn_result_callback bits_btn_result_cb;
 
-    uint16_t combo_sorted_indices[BITS_BTN_MAX_COMBO_BUTTONS];
+    button_obj_combo_t *combo_sorted[BITS_BTN_MAX_COMBO_BUTTONS];      // Combo buttons in priority order
+    button_mask_type_t combo_masks[BITS_BTN_MAX_COMBO_BUTTONS];      // Combo masks in priority order, for bulk evaluation
+    uint32_t combo_active_bits[BITS_BTN_COMBO_BITMAP_WORDS];         // Combos, in priority order, that are not idle
+
+    bits_btn_compiled_param_t compiled_params[BITS_BTN_MAX_PARAM_SETS];
+    uint8_t compiled_params_cnt;
+
+    uint8_t keymap_param_index[BITS_BTN_MAX_LAYERS * BITS_BTN_MAX_KEYS];   // Compiled keymap parameters
+    uint8_t layer_cnt;
+    uint8_t base_layer;
+    uint8_t momentary_layer;                    // Layer held by a BITS_BTN_ACTION_LAYER_MO key, or BITS_BTN_NO_LAYER
+    uint8_t momentary_owner;                    // Button index holding the momentary layer
+
+    bits_btn_seq_node_t seq_nodes[BITS_BTN_MAX_SEQUENCE_NODES];
+    uint8_t seq_nodes_cnt;
+    uint8_t seq_node;                           // Current trie node, 0 is the root
+    uint32_t seq_deadline;
+
+#if BITS_BTN_MAX_DUAL_ROLE_KEYS > 0
+    uint8_t dual_role_cnt;
+    uint8_t dual_role_btn_index[BITS_BTN_MAX_DUAL_ROLE_KEYS];
+    uint32_t dual_role_hold_time[BITS_BTN_MAX_DUAL_ROLE_KEYS];
+    uint32_t dual_role_deadline[BITS_BTN_MAX_DUAL_ROLE_KEYS];      // Hold time expiry of an undecided key
+    button_mask_type_t dual_role_other_mask[BITS_BTN_MAX_DUAL_ROLE_KEYS];   // Keys pressed while undecided
+    button_mask_type_t dual_role_mask;          // Single buttons that are dual-role keys
+    button_mask_type_t dual_pending_mask;       // Dual-role keys pressed but not decided yet
+    button_mask_type_t dual_hold_mask;          // Dual-role keys whose current gesture is a hold
+    bits_btn_deferred_event_t dual_events[BITS_BTN_DUAL_ROLE_EVENT_SIZE];   // Held back until decided
+    uint8_t dual_events_cnt;
+#endif
+
+#if BITS_BTN_MAX_PRIORITY_KEYS > 0
+    uint8_t priority_cnt;
+    uint8_t priority_btn_index[BITS_BTN_MAX_PRIORITY_KEYS];
+    uint32_t priority_press_time[BITS_BTN_MAX_PRIORITY_KEYS];
+    uint32_t priority_release_time[BITS_BTN_MAX_PRIORITY_KEYS];
+    uint32_t priority_deadline[BITS_BTN_MAX_PRIORITY_KEYS];       // Debounce expiry of a level change
+    button_mask_type_t priority_mask;           // Single buttons handled as priority keys
+    button_mask_type_t priority_pressed_mask;   // Debounced level of the priority keys
+    button_mask_type_t priority_changing_mask;  // Priority keys whose level differs from the debounced one
+    bits_btn_result_callback priority_cb;
+#endif
+
+#if BITS_BTN_COMBO_TERM_MS > 0
+    button_mask_type_t combo_member_mask;       // Single keys that belong to a suppressing combo
+    button_mask_type_t deferred_mask;           // Member keys whose events are being held back
+    uint32_t combo_term_time;
+    uint32_t deferred_deadline;
+    bits_btn_deferred_event_t deferred_events[BITS_BTN_DEFERRED_EVENT_SIZE];
+    uint8_t deferred_cnt;
+#endif
 } bits_button_t;
 
 // Buffer operation interface for unified buffer management
@@ -151,6 +454,18 @@ typedef struct
     uint8_t (*peek)(bits_btn_result_t *result);
 } bits_btn_buffer_ops_t;
 
+// Zero-copy view of the readable events of the built-in ring buffer, oldest first:
+// first[0..first_len) then second[0..second_len) when the readable range wraps around.
+typedef struct
+{
+    const bits_btn_result_t *first;
+    size_t first_len;
+    const bits_btn_result_t *second;            // NULL when the range does not wrap
+    size_t second_len;
+    size_t read_idx;                            // Internal: read index when the view was taken
+    size_t overwrite_count;                     // Internal: overwrite count when the view was taken
+} bits_btn_buffer_view_t;
+
 /**
   * @brief  Initialize the button structure and configure button detection parameters.
   *         This function sets up the button system, including single and combination buttons,
@@ -175,6 +490,20 @@ typedef struct
   *               combination button configuration does not exist in the single button array.
   *         - -2: Invalid input parameters. Returned if either `btns` or `read_button_level_func` is NULL.
   *         - -3: Too many combo buttons. The number of combo buttons exceeds the maximum allowed.
+  *         - -4: External buffer mode is enabled but no buffer ops were set.
+  *         - -5: Too many distinct parameter sets. The buttons reference more than
+  *               BITS_BTN_MAX_PARAM_SETS different bits_btn_obj_param_t objects.
+  *         - -6: Invalid key sequence. A sequence set by bits_button_set_sequences() is empty,
+  *               uses an unknown key ID, or the sequences need more than
+  *               BITS_BTN_MAX_SEQUENCE_NODES trie nodes.
+  *         - -8: Invalid keymap. The keymap set by bits_button_set_keymap() has more than
+  *               BITS_BTN_MAX_LAYERS layers or switches to a layer that does not exist.
+  *         - -9: Invalid dual-role keys. A key set by bits_button_set_dual_roles() is unknown,
+  *               listed twice, or there are more than BITS_BTN_MAX_DUAL_ROLE_KEYS of them.
+  *         - -10: Invalid priority keys. A key set by bits_button_set_priority_keys() is unknown,
+  *               listed twice, a member of a combo, sequence or dual-role key, or there are
+  *               more than BITS_BTN_MAX_PRIORITY_KEYS of them.
+  *         - -11: Too many single buttons. `btns_cnt` exceeds BITS_BTN_MAX_KEYS.
   */
 int32_t bits_button_init(button_obj_t* btns                                     , \
                          uint16_t btns_cnt                                      , \
@@ -186,11 +515,284 @@ int32_t bits_button_init(button_obj_t* btns
 );
 
 /**
-  * @brief  Background ticks function, called repeatedly by the timer with an interval of 5ms.
+  * @brief  Background ticks function, called repeatedly by the timer with an interval of 5ms
+  *         (BITS_BTN_TICKS_INTERVAL). With a time source set by bits_button_set_time_source(),
+  *         the interval may vary.
   * @retval None
   */
 void bits_button_ticks(void);
 
+/**
+  * @brief  Set the engine context, an application pointer the callbacks fetch with
+  *         bits_button_get_context(), e.g. the C++ object a static trampoline forwards to.
+  * @param  context: Application pointer, kept across bits_button_init().
+  * @retval None
+  */
+void bits_button_set_context(void *context);
+
+/**
+  * @brief  Get the engine context set by bits_button_set_context().
+  * @retval Application pointer, NULL if none was set.
+  */
+void *bits_button_get_context(void);
+
+/**
+  * @brief  Split event handling between bits_button_ticks() and thread context. When enabled,
+  *         a tick only records its events into a lock-free queue; bits_button_process() then runs
+  *         the debug output, the result filter, the buffer write and the result callback.
+  *         This keeps a tick running in a timer ISR short whatever the callbacks do.
+  * @note   With BITS_BTN_THREAD_LOCAL_ENGINE the queue belongs to the engine of the calling
+  *         thread, so bits_button_process() must run on the thread that runs the ticks.
+  * @param  enabled: true for deferred callbacks, false to run them inside the tick (default).
+  * @retval None
+  * @note   Priority key events still go to their fast callback inside the tick.
+  */
+void bits_button_set_deferred_callbacks(uint8_t enabled);
+
+/**
+  * @brief  Run the callbacks of the events recorded by bits_button_ticks() in deferred mode.
+  *         Call it from thread context; it may run concurrently with bits_button_ticks().
+  * @retval Number of events handled, 0 as well when the calling thread has no engine.
+  */
+uint16_t bits_button_process(void);
+
+/**
+  * @brief  Deliver the events of a tick in one call instead of one result callback per event.
+  *         Events are gathered while the tick runs and passed once it ends, combo events first,
+  *         then single button events, each group in report order. bits_button_feed_samples()
+  *         and, in deferred mode, bits_button_process() deliver one batch per call instead.
+  * @param  batch_cb: Batch callback, NULL to go back to the per-event result callback.
+  * @retval None
+  * @note   The result callback is not called while a batch callback is set; the debug output
+  *         and the buffer write are unchanged. A tick reporting more than BITS_BTN_BATCH_SIZE
+  *         events delivers them in several batches. In deferred mode the batch callback is only
+  *         called from bits_button_process(), never from bits_button_ticks().
+  */
+void bits_button_set_batch_callback(bits_btn_batch_callback batch_cb);
+
+/**
+  * @brief  Measure the cost of every bits_button_ticks() call with a cycle counter.
+  * @param  cycle_counter: Free-running counter, e.g. DWT->CYCCNT. NULL stops measuring cost,
+  *                        the event counts of the statistics are kept anyway.
+  * @retval None
+  */
+void bits_button_set_cycle_counter(bits_btn_get_time_func cycle_counter);
+
+/**
+  * @brief  Get the tick cost statistics. In deferred mode the events a tick may record are
+  *         bounded by BITS_BTN_EVENT_QUEUE_SIZE; dropped_events shows whether it was reached.
+  *         Every tick publishes them at its end, so they can be read from thread context
+  *         while the ticks run in a timer ISR, like bits_button_get_snapshot().
+  * @param  stats: Pointer to store the statistics.
+  * @retval 1 if a consistent copy was taken, 0 if a tick kept publishing meanwhile;
+  *         try again later.
+  */
+uint8_t bits_button_get_tick_stats(bits_btn_tick_stats_t *stats);
+
+/**
+  * @brief  Clear the tick cost statistics. Safe against a running tick: the next
+  *         bits_button_ticks() clears them before it starts measuring.
+  * @retval None
+  */
+void bits_button_reset_tick_stats(void);
+
+/**
+  * @brief  Read the key state published by the last tick, without consuming buffered events.
+  *         Lock-free and safe to call from another thread or at a higher interrupt priority.
+  * @param  snapshot: Pointer to store the snapshot.
+  * @retval 1 if a consistent snapshot was copied, 0 if a tick kept publishing meanwhile
+  *         or the snapshot is compiled out (BITS_BTN_DISABLE_SNAPSHOT); try again later.
+  *         Also 0 when bits_button_init() has not run: with BITS_BTN_THREAD_LOCAL_ENGINE
+  *         only the thread that owns the engine can read its snapshot.
+  * @note   Priority keys appear with their debounced level in both masks.
+  * @note   Reading from another core needs C11 atomics or GCC/Clang for the memory barriers;
+  *         with other pre-C11 compilers the snapshot is only consistent on a single core.
+  */
+uint8_t bits_button_get_snapshot(bits_btn_snapshot_t *snapshot);
+
+/**
+  * @brief  Skip reading the keys while the engine is idle. Once enabled, bits_button_ticks()
+  *         only reads the keys after bits_button_notify_change(), while a key is pressed, or
+  *         while a deadline or configuration change is pending; otherwise it just advances time.
+  * @param  enabled: true to enable, false to read the keys on every tick (default).
+  * @retval None
+  * @note   Every key, including priority keys, must raise a pin-change interrupt that calls
+  *         bits_button_notify_change().
+  */
+void bits_button_enable_change_notification(uint8_t enabled);
+
+/**
+  * @brief  Notify the engine that a key level may have changed. Safe to call from an ISR.
+  * @retval None
+  * @note   Not usable with BITS_BTN_THREAD_LOCAL_ENGINE: an ISR has no engine of its own.
+  */
+void bits_button_notify_change(void);
+
+/**
+  * @brief  Run debounce and the state machines over a batch of raw port samples, e.g. captured
+  *         by timer-triggered DMA, instead of calling bits_button_ticks() for each of them.
+  *         Runs of identical samples are skipped except where a deadline expires, so a batch
+  *         in which no key changes costs little more than one tick.
+  * @param  masks: Raw samples, bit i set when single button i is at its active level.
+  * @param  n: Number of samples.
+  * @param  sample_period: Time between two samples in bits_button_get_time() units (ticks, or
+  *                        time source units). With a time source the last sample is taken as
+  *                        the current time; samples older than the engine time are processed
+  *                        at the engine time. Without a time source it is a whole number of
+  *                        BITS_BTN_TICKS_INTERVAL ticks: samples taken faster than the tick need
+  *                        a time source with a finer unit (e.g. 1 us or 1 ms), or the caller
+  *                        keeps one sample per tick.
+  * @retval 0 if the samples were processed, -2 if `masks` is NULL or `sample_period` is 0.
+  * @note   Disabled keys still read as released. Do not mix with bits_button_ticks() in the
+  *         same period: each call already advances the engine time.
+  */
+int32_t bits_button_feed_samples(const button_mask_type_t *masks, size_t n, uint32_t sample_period);
+
+/**
+  * @brief  Get the current engine time.
+  * @retval Number of ticks processed since bits_button_init(), or the time source value
+  *         sampled by the last tick when a time source is set.
+  */
+uint32_t bits_button_get_time(void);
+
+/**
+  * @brief  Get the earliest time at which a tick is needed even if no button level changes.
+  *         This covers the debounce window, long press, hold period and release window
+  *         deadlines of all single and combo buttons.
+  * @param  deadline: Pointer to store the earliest deadline, in bits_button_get_time() units.
+  * @retval true(1) if a deadline is pending, false if every button is idle.
+  */
+uint8_t bits_button_get_next_deadline(uint32_t *deadline);
+
+/**
+  * @brief  Use a monotonic clock instead of counting bits_button_ticks() calls.
+  *         All timeouts are then measured in real elapsed time, so bits_button_ticks() may be
+  *         called irregularly or at a low rate without stretching gestures. The release window
+  *         then starts at the detected release, independent of the caller's tick period.
+  * @param  time_func: Function returning a free-running monotonic time, e.g. in ms or us.
+  *                   Wrap-around is handled. Pass NULL to go back to counting ticks.
+  * @param  time_units_per_ms: Number of `time_func` units per millisecond (1 for ms, 1000 for us).
+  * @retval None
+  * @note   This function should be called before bits_button_init().
+  */
+void bits_button_set_time_source(bits_btn_get_time_func time_func, uint32_t time_units_per_ms);
+
+/**
+  * @brief  Set ordered key sequences recognized across different buttons.
+  *         Each press of a single button advances the sequence trie built by bits_button_init();
+  *         a completed sequence is reported as a BTN_STATE_FINISH event with the sequence key_id.
+  * @param  sequences: Array of sequences, kept by reference. Pass NULL to remove all sequences.
+  * @param  sequences_cnt: Number of sequences.
+  * @retval None
+  * @note   This function should be called before bits_button_init().
+  */
+void bits_button_set_sequences(bits_btn_sequence_t *sequences, uint16_t sequences_cnt);
+
+/**
+  * @brief  Set tap-hold dual-role keys. While a dual-role key is undecided, the events of all
+  *         buttons are held back and reported in order once it is decided, so a key pressed
+  *         under a held modifier is always reported after the modifier.
+  * @param  dual_roles: Array of dual-role keys, kept by reference. Pass NULL to remove them.
+  * @param  dual_roles_cnt: Number of dual-role keys.
+  * @retval None
+  * @note   This function should be called before bits_button_init().
+  */
+void bits_button_set_dual_roles(const bits_btn_dual_role_t *dual_roles, uint8_t dual_roles_cnt);
+
+/**
+  * @brief  Set priority keys (e.g. emergency stop, power). They are read and debounced before
+  *         anything else in bits_button_ticks() and reported straight to `fast_cb`, so their
+  *         latency does not depend on the other keys, the combo dispatch or the event buffer.
+  * @param  priority_keys: Array of priority keys, kept by reference. Pass NULL to remove them.
+  * @param  priority_keys_cnt: Number of priority keys.
+  * @param  fast_cb: Callback for priority key events. NULL uses the result callback of bits_button_init().
+  * @retval None
+  * @note   This function should be called before bits_button_init(). Priority keys never take
+  *         part in combos, sequences or dual-role decisions.
+  */
+void bits_button_set_priority_keys(const bits_btn_priority_key_t *priority_keys, uint8_t priority_keys_cnt,
+                                   bits_btn_result_callback fast_cb);
+
+/**
+  * @brief  Set a layered keymap, so one set of physical buttons maps to several logical key IDs.
+  *         The layer is latched when a gesture starts: all events of that gesture report the
+  *         key ID and use the parameters of that layer, even if the layer changes meanwhile.
+  * @param  keymap: Flat array of layer_cnt * btns_cnt entries, kept by reference. NULL removes it.
+  * @param  layer_cnt: Number of layers.
+  * @retval None
+  * @note   This function should be called before bits_button_init(), which compiles the
+  *         keymap parameters. Combo buttons keep their own key ID and parameters.
+  */
+void bits_button_set_keymap(const bits_btn_keymap_entry_t *keymap, uint8_t layer_cnt);
+
+/**
+  * @brief  Switch the base layer. Gestures already started keep their layer.
+  * @param  layer: New base layer.
+  * @retval None
+  */
+void bits_button_set_layer(uint8_t layer);
+
+/**
+  * @brief  Get the layer new gestures start in: the momentary layer while a
+  *         BITS_BTN_ACTION_LAYER_MO key is held, the base layer otherwise.
+  * @retval Active layer.
+  */
+uint8_t bits_button_get_layer(void);
+
+/**
+  * @brief  Runtime reconfiguration without bits_button_init().
+  *         These functions validate the change and queue it; bits_button_ticks() applies all
+  *         queued changes at the start of its next call, so a change never interleaves with a
+  *         running dispatch and gestures in flight on other buttons are kept. They may be called
+  *         from one context concurrently with bits_button_ticks() (e.g. main loop vs. timer ISR):
+  *         they validate against their own record of the combo list with the queued changes
+  *         included, and queue key IDs that the tick resolves, so they never read the button
+  *         state the tick rewrites. Calls from several contexts must be serialized by the caller.
+  *         With BITS_BTN_THREAD_LOCAL_ENGINE they change the engine of the calling thread only.
+  *
+  * @retval Common status codes:
+  *         - 0: The change is queued.
+  *         - -1: Unknown key ID, or the combo key ID is already registered.
+  *         - -2: Invalid parameters, e.g. a combo with a priority key among its members.
+  *         - -3: Too many combo buttons.
+  *         - -4: bits_button_init() has not run (in the calling thread with
+  *               BITS_BTN_THREAD_LOCAL_ENGINE).
+  *         - -5: Too many distinct parameter sets (entries of the parameter table are never freed).
+  *         - -7: The configuration queue is full (BITS_BTN_CONFIG_QUEUE_SIZE - 1 pending changes).
+  */
+
+/**
+  * @brief  Add a combo button. The combo object must stay valid while it is registered.
+  * @param  combo: Combo button initialized with BITS_BUTTON_COMBO_INIT().
+  * @retval See the common status codes above.
+  */
+int32_t bits_button_add_combo(button_obj_combo_t *combo);
+
+/**
+  * @brief  Remove a registered combo button. Its member keys are no longer suppressed.
+  * @param  combo_key_id: Key ID of the combo button.
+  * @retval See the common status codes above.
+  */
+int32_t bits_button_remove_combo(uint16_t combo_key_id);
+
+/**
+  * @brief  Change the parameters of a single or combo button. A timed state that is already
+  *         running keeps its deadline, the new timing applies from the next state change.
+  * @param  key_id: Key ID of a single or combo button.
+  * @param  param: New parameters.
+  * @retval See the common status codes above.
+  */
+int32_t bits_button_set_param(uint16_t key_id, const bits_btn_obj_param_t *param);
+
+/**
+  * @brief  Enable or disable a single key. A disabled key is not read and behaves as released,
+  *         so a gesture in flight finishes normally.
+  * @param  key_id: Key ID of a single button.
+  * @param  enabled: true to enable, false to disable.
+  * @retval See the common status codes above.
+  */
+int32_t bits_button_set_key_enabled(uint16_t key_id, uint8_t enabled);
+
 /**
   * @brief  Get the button key result from the buffer.
   * @param  result: Pointer to store the button key result
@@ -209,9 +811,15 @@ uint8_t bits_button_peek_key_result(bits_btn_result_t *result);
   * @brief  Reset all button states to idle.
   *         This function should be called when resuming from low power mode
   *         to clear any residual button states from before the pause.
-  * @retval None
+  *         It is wait-free and safe against a running tick: the reset is applied by the next
+  *         bits_button_ticks() call before it reads the keys. Events reported before that
+  *         boundary, including those of a tick running meanwhile, are dropped by the readers:
+  *         bits_button_get_key_result(), the peek and view functions, and bits_button_process()
+  *         in deferred callback mode.
+  * @retval true if the reset is requested, false if bits_button_init() has not run, e.g. in
+  *         another thread than the engine's with BITS_BTN_THREAD_LOCAL_ENGINE.
   */
-void bits_button_reset_states(void);
+uint8_t bits_button_reset_states(void);
 
 /**
   * @brief  Get the number of buffer overwrites.
@@ -262,10 +870,42 @@ size_t get_bits_btn_buffer_capacity(void);
   * @param  cb: Pointer to the user-defined filter callback function. The callback should
   *            return 1 to write the event to buffer, 0 to filter it out. Pass NULL to disable.
   * @retval None
-  * @note   Only available in buffer mode. Default behavior writes BTN_STATE_LONG_PRESS and BTN_STATE_FINISH events.
+  * @note   Only available in buffer mode. Without a callback the masks of bits_btn_set_result_filter_mask()
+  *         apply, writing BTN_STATE_LONG_PRESS and BTN_STATE_FINISH events by default.
   */
 void bits_btn_register_result_filter_callback(bits_btn_result_user_filter_callback cb);
 
+/**
+  * @brief  Declarative buffer filter: an event is written when its type is in event_mask and,
+  *         for single buttons, the button is in key_mask. Checked without a function call.
+  * @param  event_mask: Event types to keep, built with BITS_BTN_EVENT_BIT(),
+  *                     BITS_BTN_DEFAULT_EVENT_MASK by default.
+  * @param  key_mask: Single buttons to keep, bit n for the n-th button given to bits_button_init().
+  *                   Combo and sequence events only go through event_mask.
+  * @retval None
+  * @note   Only available in buffer mode. A filter callback registered with
+  *         bits_btn_register_result_filter_callback() takes precedence.
+  */
+void bits_btn_set_result_filter_mask(uint32_t event_mask, button_mask_type_t key_mask);
+
+/**
+  * @brief  Map the buffered events in place, without copying or removing them.
+  *         The events stay in the buffer until bits_btn_buffer_release_view() consumes
+  *         them all at once, so the view must be released before the next read from the buffer.
+  * @param  view: Filled with at most two contiguous parts, both empty if there is nothing to read.
+  * @retval true(1) if the view holds events, false if the buffer is empty or not the built-in one.
+  * @note   Only available with the built-in buffer (not BITS_BTN_USE_USER_BUFFER or BITS_BTN_DISABLE_BUFFER).
+  */
+uint8_t bits_btn_buffer_acquire_view(bits_btn_buffer_view_t *view);
+
+/**
+  * @brief  Consume every event of a view with a single update of the read index.
+  * @param  view: View returned by bits_btn_buffer_acquire_view().
+  * @retval true(1) if the events stayed intact, false if the writer overwrote the oldest
+  *         of them while the view was held (buffer full); those events may have been read torn.
+  */
+uint8_t bits_btn_buffer_release_view(const bits_btn_buffer_view_t *view);
+
 #ifdef __cplusplus
 }
 #endif
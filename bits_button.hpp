@@ -0,0 +1,705 @@
+#ifndef __BITS_BUTTON_HPP__
+#define __BITS_BUTTON_HPP__
+
+// Header-only C++17 front end of BitsButton.
+//
+// The button table, the combo table and the timings are described by a Config type and
+// checked at compile time, and the parameter set, combo masks and combo order are constants.
+// The C engine underneath is unchanged: it still calls the read and result handlers through
+// a function pointer, here a per-handler trampoline that calls the functor or lambda directly.
+// The trampolines find the Engine through detail::active_engine rather than
+// bits_button_get_context(), so the application keeps the context for itself. Debounce,
+// buffer size and mask width stay compile-time options of bits_button.c, not Config members.
+// Only one Engine can be started at a time, as it drives the (per thread, see
+// BITS_BTN_THREAD_LOCAL_ENGINE) singleton engine; compile-time options such as
+// BITS_BTN_DEBOUNCE_TIME_MS or BITS_BTN_BUFFER_SIZE are still set when building bits_button.c.
+//
+//     struct PanelConfig : bits::DefaultConfig {
+//         static constexpr std::array<bits::Key, 3> keys{{{1}, {2}, {3, 0}}};
+//         static constexpr std::array<bits::Combo, 1> combos{{bits::Combo(100, {1, 2})}};
+//     };
+//
+//     bits::Engine<3, 1, PanelConfig> engine;
+//     auto read = [](std::size_t index) { return gpio_read(pins[index]); };
+//     auto on_event = [](const bits_btn_result_t &result) { handle(result); };
+//     engine.start(read, on_event);
+//
+// With C++20 a coroutine can wait on buffered events instead, resumed by engine.tick():
+//
+//     bits::Task unlock_flow(PanelEngine &engine) {
+//         co_await engine.next_gesture(1, BITS_BTN_DOUBLE_CLICK_KV);
+//         co_await engine.next_gesture(1, BITS_BTN_LONG_PRESEE_START_KV);
+//         unlock();
+//     }
+//
+// Buffered events can also be walked in place, consumed together when the view goes away:
+//
+//     {
+//         auto view = engine.events();
+//         auto holds = std::count_if(view.begin(), view.end(), is_long_press);
+//     }
+
+#include "bits_button.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "bits_button.hpp requires C++17"
+#endif
+
+// C++20: co_await engine.next_event() / engine.next_gesture(), resumed by Engine::tick()
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define BITS_BTN_HAS_COROUTINES     1
+#endif
+#endif
+
+namespace bits {
+
+constexpr std::size_t kMaxComboKeys = 8;
+
+// Engine::start() result when another Engine already drives the C engine
+constexpr int32_t kEngineBusy = -12;
+
+// A single button: key ID, active level, leading-edge debounce (see BITS_BUTTON_EAGER_INIT).
+struct Key
+{
+    uint16_t id;
+    uint8_t active_level = 1;
+    bool eager = false;
+};
+
+// A combo button: key ID, member key IDs, and whether member events are suppressed.
+struct Combo
+{
+    uint16_t id = 0;
+    std::array<uint16_t, kMaxComboKeys> keys{};
+    uint8_t count = 0;
+    bool suppress = true;
+
+    constexpr Combo() = default;
+
+    template <std::size_t K>
+    constexpr Combo(uint16_t combo_id, const uint16_t (&members)[K], bool suppress_singles = true)
+        : id(combo_id), count(static_cast<uint8_t>(K)), suppress(suppress_singles)
+    {
+        static_assert(K >= 2 && K <= kMaxComboKeys, "a combo needs 2 to kMaxComboKeys members");
+        for (std::size_t i = 0; i < K; i++)
+            keys[i] = members[i];
+    }
+};
+
+// Timings shared by every button of an Engine; derive from it and add keys and combos.
+struct DefaultConfig
+{
+    static constexpr uint16_t short_press_time_ms = BITS_BTN_SHORT_TIME_MS;
+    static constexpr uint16_t long_press_start_time_ms = BITS_BTN_LONG_PRESS_START_TIME_MS;
+    static constexpr uint16_t long_press_period_ms = BITS_BTN_LONG_PRESS_PERIOD_TRIGER_MS;
+    static constexpr uint16_t time_window_time_ms = BITS_BTN_TIME_WINDOW_TIME_MS;
+    static constexpr uint16_t long_press_period_min_ms = 0;
+    static constexpr uint16_t long_press_period_step_ms = 0;
+    static constexpr std::array<Combo, 0> combos{};
+    static constexpr std::size_t event_backlog = 16;    // Events set aside while coroutines wait
+    static constexpr std::size_t handler_size = 4 * sizeof(void *); // Room for each handler copy
+};
+
+namespace detail {
+
+// Engine started on the C singleton, read by the handler trampolines
+#ifdef BITS_BTN_THREAD_LOCAL_ENGINE
+inline thread_local void *active_engine = nullptr;
+#else
+inline void *active_engine = nullptr;
+#endif
+
+// A handler copied into the Engine, without the heap allocation of std::function
+template <std::size_t Size>
+class Handler
+{
+public:
+    Handler() = default;
+    ~Handler() { reset(); }
+
+    Handler(const Handler &) = delete;
+    Handler &operator=(const Handler &) = delete;
+
+    template <typename Fn>
+    void emplace(Fn &&fn)
+    {
+        using Stored = std::decay_t<Fn>;
+
+        static_assert(sizeof(Stored) <= Size, "handler does not fit Config::handler_size, pass std::ref(handler)");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "handler is over-aligned");
+
+        reset();
+        ::new (static_cast<void *>(storage_)) Stored(std::forward<Fn>(fn));
+        destroy_ = [](void *stored) { static_cast<Stored *>(stored)->~Stored(); };
+    }
+
+    template <typename Stored>
+    Stored &get() { return *std::launder(reinterpret_cast<Stored *>(storage_)); }
+
+    void reset()
+    {
+        if (destroy_ != nullptr)
+            destroy_(storage_);
+        destroy_ = nullptr;
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[Size];
+    void (*destroy_)(void *) = nullptr;
+};
+
+template <std::size_t N>
+constexpr int index_of(const std::array<Key, N> &keys, uint16_t id)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        if (keys[i].id == id)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+template <std::size_t N>
+constexpr bool keys_unique(const std::array<Key, N> &keys)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        if (index_of(keys, keys[i].id) != static_cast<int>(i))
+            return false;
+    }
+    return true;
+}
+
+template <std::size_t N>
+constexpr button_mask_type_t combo_mask(const std::array<Key, N> &keys, const Combo &combo)
+{
+    button_mask_type_t mask = 0;
+
+    for (std::size_t i = 0; i < combo.count; i++)
+    {
+        int index = index_of(keys, combo.keys[i]);
+
+        if (index >= 0)
+            mask |= (button_mask_type_t)1 << index;
+    }
+    return mask;
+}
+
+// Every member is a distinct single button, and combo IDs clash neither with keys nor each other.
+template <std::size_t N, std::size_t M>
+constexpr bool combos_valid(const std::array<Key, N> &keys, const std::array<Combo, M> &combos)
+{
+    for (std::size_t i = 0; i < M; i++)
+    {
+        const Combo &combo = combos[i];
+        button_mask_type_t mask = 0;
+
+        if (combo.count < 2 || index_of(keys, combo.id) >= 0)
+            return false;
+
+        for (std::size_t j = 0; j < combo.count; j++)
+        {
+            int index = index_of(keys, combo.keys[j]);
+
+            if (index < 0 || (mask & ((button_mask_type_t)1 << index)))
+                return false;
+            mask |= (button_mask_type_t)1 << index;
+        }
+
+        for (std::size_t j = 0; j < i; j++)
+        {
+            if (combos[j].id == combo.id)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <std::size_t N, std::size_t M>
+constexpr bool combo_masks_distinct(const std::array<Key, N> &keys, const std::array<Combo, M> &combos)
+{
+    for (std::size_t i = 0; i < M; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            if (combo_mask(keys, combos[i]) == combo_mask(keys, combos[j]))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Combo indices by descending member count, stable: the order bits_button_init() sorts to,
+// so handing the combos over in this order leaves its insertion sort nothing to move.
+template <std::size_t M>
+constexpr std::array<std::size_t, M> combo_order(const std::array<Combo, M> &combos)
+{
+    std::array<std::size_t, M> order{};
+
+    for (std::size_t i = 0; i < M; i++)
+    {
+        std::size_t pos = i;
+
+        while (pos > 0 && combos[order[pos - 1]].count < combos[i].count)
+        {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+    return order;
+}
+
+} // namespace detail
+
+#ifdef BITS_BTN_HAS_COROUTINES
+// Fire-and-forget coroutine started at once, e.g. a UI flow waiting on button events.
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// co_await result of Engine::next_event() and Engine::next_gesture(). Waiting coroutines are
+// kept in an intrusive list in the Engine and resumed from Engine::tick(), in await order.
+class EventAwaiter
+{
+public:
+    EventAwaiter(EventAwaiter **waiters, bool any_key, uint16_t key_id, bool match_value, key_value_type_t key_value)
+        : waiters_(waiters), any_key_(any_key), match_value_(match_value), key_id_(key_id), key_value_(key_value)
+    {
+    }
+
+    // Linked into the waiter list by address while suspended
+    EventAwaiter(const EventAwaiter &) = delete;
+    EventAwaiter &operator=(const EventAwaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        EventAwaiter **link = waiters_;
+
+        handle_ = handle;
+        while (*link != nullptr)
+            link = &(*link)->next_;
+        *link = this;
+    }
+
+    bits_btn_result_t await_resume() const noexcept { return result_; }
+
+    // Whether any waiter in the list takes the event
+    static bool wanted(const EventAwaiter *waiters, const bits_btn_result_t &result)
+    {
+        for (; waiters != nullptr; waiters = waiters->next_)
+        {
+            if (waiters->matches(result))
+                return true;
+        }
+        return false;
+    }
+
+    // Resume the waiters the event matches; waiters added meanwhile wait for the next event
+    static void dispatch(EventAwaiter **waiters, const bits_btn_result_t &result)
+    {
+        EventAwaiter *ready = nullptr;
+        EventAwaiter **ready_tail = &ready;
+        EventAwaiter **link = waiters;
+
+        while (*link != nullptr)
+        {
+            EventAwaiter *waiter = *link;
+
+            if (waiter->matches(result))
+            {
+                *link = waiter->next_;
+                waiter->next_ = nullptr;
+                waiter->result_ = result;
+                *ready_tail = waiter;
+                ready_tail = &waiter->next_;
+            }
+            else
+            {
+                link = &waiter->next_;
+            }
+        }
+
+        while (ready != nullptr)
+        {
+            EventAwaiter *waiter = ready;
+
+            ready = waiter->next_;
+            waiter->next_ = nullptr;
+            waiter->handle_.resume();
+        }
+    }
+
+private:
+    bool matches(const bits_btn_result_t &result) const
+    {
+        return (any_key_ || key_id_ == result.key_id) && (!match_value_ || key_value_ == result.key_value);
+    }
+
+    EventAwaiter **waiters_;
+    EventAwaiter *next_ = nullptr;
+    std::coroutine_handle<> handle_;
+    bool any_key_;
+    bool match_value_;
+    uint16_t key_id_;
+    key_value_type_t key_value_;
+    bits_btn_result_t result_{};
+};
+#endif
+
+// Contiguous run of buffered events, iterated with plain pointers.
+class EventSpan
+{
+public:
+    constexpr EventSpan() = default;
+    constexpr EventSpan(const bits_btn_result_t *data, std::size_t size) : data_(data), size_(size) {}
+
+    constexpr const bits_btn_result_t *data() const { return data_; }
+    constexpr std::size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+    constexpr const bits_btn_result_t *begin() const { return data_; }
+    constexpr const bits_btn_result_t *end() const { return data_ + size_; }
+    constexpr const bits_btn_result_t &operator[](std::size_t index) const { return data_[index]; }
+
+private:
+    const bits_btn_result_t *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Zero-copy view of the events in the built-in ring buffer, oldest first, as at most two
+// spans. The events are consumed together, with one read index update, when the view is
+// released or destroyed; do not read the buffer by other means while a view is alive.
+class EventView
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = bits_btn_result_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const bits_btn_result_t *;
+        using reference = const bits_btn_result_t &;
+
+        iterator() = default;
+        iterator(pointer pos, pointer hop_from, pointer hop_to) : pos_(pos), hop_from_(hop_from), hop_to_(hop_to) {}
+
+        reference operator*() const { return *pos_; }
+        pointer operator->() const { return pos_; }
+
+        // Jump from the end of the first span to the start of the second
+        iterator &operator++()
+        {
+            if (++pos_ == hop_from_)
+                pos_ = hop_to_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator prev = *this;
+
+            ++*this;
+            return prev;
+        }
+
+        friend bool operator==(const iterator &a, const iterator &b) { return a.pos_ == b.pos_; }
+        friend bool operator!=(const iterator &a, const iterator &b) { return a.pos_ != b.pos_; }
+
+    private:
+        pointer pos_ = nullptr;
+        pointer hop_from_ = nullptr;
+        pointer hop_to_ = nullptr;
+    };
+
+    EventView() { bits_btn_buffer_acquire_view(&view_); }
+    ~EventView() { release(); }
+
+    EventView(const EventView &) = delete;
+    EventView &operator=(const EventView &) = delete;
+
+    EventSpan first() const { return EventSpan(view_.first, released_ ? 0 : view_.first_len); }
+    EventSpan second() const { return EventSpan(view_.second, released_ ? 0 : view_.second_len); }
+    std::size_t size() const { return first().size() + second().size(); }
+    bool empty() const { return size() == 0; }
+
+    iterator begin() const
+    {
+        EventSpan head = first();
+        EventSpan tail = second();
+
+        return iterator(head.begin(), head.end(), tail.empty() ? head.end() : tail.begin());
+    }
+
+    iterator end() const
+    {
+        EventSpan head = first();
+        EventSpan tail = second();
+
+        return iterator(tail.empty() ? head.end() : tail.end(), nullptr, nullptr);
+    }
+
+    /**
+      * @brief  Consume the events of the view now; the view is empty afterwards.
+      * @retval false if the writer overwrote some of them while the view was held.
+      */
+    bool release()
+    {
+        if (!released_)
+        {
+            released_ = true;
+            intact_ = bits_btn_buffer_release_view(&view_) != 0;
+        }
+        return intact_;
+    }
+
+private:
+    bits_btn_buffer_view_t view_{};
+    bool released_ = false;
+    bool intact_ = true;
+};
+
+template <std::size_t NumButtons, std::size_t NumCombos, typename Config = DefaultConfig>
+class Engine
+{
+    static_assert(NumButtons > 0 && NumButtons <= BITS_BTN_MAX_KEYS, "NumButtons must be 1 to BITS_BTN_MAX_KEYS");
+    static_assert(Config::keys.size() == NumButtons, "Config::keys must list NumButtons keys");
+    static_assert(NumCombos <= BITS_BTN_MAX_COMBO_BUTTONS, "NumCombos must not exceed BITS_BTN_MAX_COMBO_BUTTONS");
+    static_assert(Config::combos.size() == NumCombos, "Config::combos must list NumCombos combos");
+    static_assert(detail::keys_unique(Config::keys), "duplicate key ID in Config::keys");
+    static_assert(detail::combos_valid(Config::keys, Config::combos),
+                  "combo member is not a key of Config::keys, is repeated, or a combo ID is reused");
+    static_assert(detail::combo_masks_distinct(Config::keys, Config::combos), "two combos have the same members");
+    static_assert(Config::event_backlog > 0, "Config::event_backlog must not be 0");
+
+public:
+    static constexpr bits_btn_obj_param_t param = {
+        Config::short_press_time_ms, Config::long_press_start_time_ms, Config::long_press_period_ms,
+        Config::time_window_time_ms, Config::long_press_period_min_ms, Config::long_press_period_step_ms
+    };
+
+    // Combos in the order handed to bits_button_init(), with their member masks
+    static constexpr std::array<std::size_t, NumCombos> combo_order = detail::combo_order(Config::combos);
+
+    static constexpr button_mask_type_t combo_mask(std::size_t combo_index)
+    {
+        return detail::combo_mask(Config::keys, Config::combos[combo_index]);
+    }
+
+    // Position of a key in Config::keys, -1 if unknown
+    static constexpr int index_of(uint16_t key_id)
+    {
+        return detail::index_of(Config::keys, key_id);
+    }
+
+    Engine()
+    {
+        for (std::size_t i = 0; i < NumButtons; i++)
+            fill_button(btns_[i], Config::keys[i].id, Config::keys[i].active_level, Config::keys[i].eager);
+
+        for (std::size_t i = 0; i < NumCombos; i++)
+        {
+            const Combo &combo = Config::combos[combo_order[i]];
+
+            combo_keys_[i] = combo.keys;
+            combos_[i] = button_obj_combo_t{};
+            combos_[i].suppress = combo.suppress;
+            combos_[i].key_count = combo.count;
+            combos_[i].key_single_ids = combo_keys_[i].data();
+            fill_button(combos_[i].btn, combo.id, 1, false);
+        }
+    }
+
+    // The C engine keeps pointers into this object; stop ticking before it goes away
+    ~Engine()
+    {
+        if (detail::active_engine == this)
+        {
+            detail::active_engine = nullptr;
+            bits_button_set_context(nullptr);
+        }
+    }
+
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+
+    /**
+      * @brief  Initialize the engine with the given handlers. The handlers are copied or moved
+      *         into the Engine, so temporaries are fine; pass std::ref(handler) to keep one by
+      *         reference, e.g. when it is larger than Config::handler_size.
+      * @param  read: Called as read(index) with the position of the key in Config::keys;
+      *               returns the raw pin level.
+      * @param  on_result: Called as on_result(const bits_btn_result_t &) for every event.
+      * @param  debug_printf: Optional debug output, as for bits_button_init().
+      * @retval Result of bits_button_init(), or kEngineBusy while another Engine is alive and started.
+      *         On failure the Engine is not started and another Engine may start.
+      */
+    template <typename ReadFn, typename ResultFn>
+    int32_t start(ReadFn &&read, ResultFn &&on_result, bits_btn_debug_printf_func debug_printf = nullptr)
+    {
+        using ReadStored = std::decay_t<ReadFn>;
+        using ResultStored = std::decay_t<ResultFn>;
+        int32_t ret;
+
+        if (detail::active_engine != nullptr && detail::active_engine != this)
+            return kEngineBusy;
+
+        detail::active_engine = this;
+        read_fn_.emplace(std::forward<ReadFn>(read));
+        result_fn_.emplace(std::forward<ResultFn>(on_result));
+        bits_button_set_context(this);
+
+        ret = bits_button_init(btns_.data(), NumButtons, NumCombos ? combos_.data() : nullptr, NumCombos,
+                               &Engine::read_trampoline<ReadStored>, &Engine::result_trampoline<ResultStored>,
+                               debug_printf);
+        if (ret != 0)
+        {
+            detail::active_engine = nullptr;
+            bits_button_set_context(nullptr);
+            read_fn_.reset();
+            result_fn_.reset();
+        }
+        return ret;
+    }
+
+    void tick()
+    {
+        bits_button_ticks();
+
+#ifdef BITS_BTN_HAS_COROUTINES
+        // Single-threaded executor: buffered events resume the coroutines waiting for them.
+        // Events no waiter takes are set aside in order for next_event(result), so they
+        // neither hold back the waiters nor get lost.
+        bits_btn_result_t result;
+
+        while (waiters_ != nullptr && bits_button_get_key_result(&result))
+        {
+            if (EventAwaiter::wanted(waiters_, result))
+                EventAwaiter::dispatch(&waiters_, result);
+            else
+                set_aside(result);
+        }
+#endif
+    }
+
+    // Next buffered event, starting with the ones tick() set aside while coroutines waited
+    bool next_event(bits_btn_result_t &result)
+    {
+#ifdef BITS_BTN_HAS_COROUTINES
+        if (aside_cnt_ > 0)
+        {
+            result = aside_[aside_head_];
+            aside_head_ = (aside_head_ + 1) % aside_.size();
+            aside_cnt_--;
+            return true;
+        }
+#endif
+        return bits_button_get_key_result(&result) != 0;
+    }
+
+    // Buffered events in place, consumed when the returned view is destroyed. Events set
+    // aside by tick() while coroutines wait are only returned by next_event(result).
+    EventView events() const { return EventView(); }
+
+    const button_obj_t &button(std::size_t index) const { return btns_[index]; }
+
+#ifdef BITS_BTN_HAS_COROUTINES
+    /**
+      * @brief  Wait for the next buffered event of any key. Only events admitted to the buffer
+      *         are seen (long press and finish by default, see bits_btn_set_result_filter_mask()).
+      * @retval Awaitable resumed by tick() with the event.
+      */
+    EventAwaiter next_event() { return EventAwaiter(&waiters_, true, 0, false, 0); }
+
+    /**
+      * @brief  Wait for a gesture of one key, e.g. next_gesture(1, BITS_BTN_DOUBLE_CLICK_KV).
+      *         Buffered events of other keys or gestures do not hold the waiter back; tick() sets
+      *         them aside for next_event(result).
+      * @param  key_id: Key to wait for.
+      * @param  pattern: key_value of the gesture.
+      * @retval Awaitable resumed by tick() with the event.
+      */
+    EventAwaiter next_gesture(uint16_t key_id, key_value_type_t pattern)
+    {
+        return EventAwaiter(&waiters_, false, key_id, true, pattern);
+    }
+#endif
+
+private:
+#ifdef BITS_BTN_HAS_COROUTINES
+    // Keep an event no waiter took; when full the oldest one is dropped, as in the ring buffer
+    void set_aside(const bits_btn_result_t &result)
+    {
+        if (aside_cnt_ == aside_.size())
+        {
+            aside_head_ = (aside_head_ + 1) % aside_.size();
+            aside_cnt_--;
+        }
+        aside_[(aside_head_ + aside_cnt_) % aside_.size()] = result;
+        aside_cnt_++;
+    }
+#endif
+
+    static void fill_button(button_obj_t &btn, uint16_t key_id, uint8_t active_level, bool eager)
+    {
+        btn = button_obj_t{};
+        btn.key_id = key_id;
+        btn.active_level = active_level;
+        btn.eager_debounce = eager;
+        btn.param = &param;
+    }
+
+    template <typename ReadStored>
+    static uint8_t read_trampoline(button_obj_t *btn)
+    {
+        Engine *self = static_cast<Engine *>(detail::active_engine);
+
+        return static_cast<uint8_t>(self->read_fn_.template get<ReadStored>()(
+            static_cast<std::size_t>(btn - self->btns_.data())));
+    }
+
+    template <typename ResultStored>
+    static void result_trampoline(button_obj_t *btn, bits_btn_result_t result)
+    {
+        Engine *self = static_cast<Engine *>(detail::active_engine);
+
+        (void)btn;
+        self->result_fn_.template get<ResultStored>()(static_cast<const bits_btn_result_t &>(result));
+    }
+
+    std::array<button_obj_t, NumButtons> btns_{};
+    std::array<std::array<uint16_t, kMaxComboKeys>, NumCombos> combo_keys_{};
+    std::array<button_obj_combo_t, NumCombos> combos_{};
+    detail::Handler<Config::handler_size> read_fn_;
+    detail::Handler<Config::handler_size> result_fn_;
+#ifdef BITS_BTN_HAS_COROUTINES
+    EventAwaiter *waiters_ = nullptr;
+    std::array<bits_btn_result_t, Config::event_backlog> aside_{};
+    std::size_t aside_head_ = 0;
+    std::size_t aside_cnt_ = 0;
+#endif
+};
+
+} // namespace bits
+
+#endif
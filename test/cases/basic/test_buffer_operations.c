@@ -203,4 +203,158 @@ void test_buffer_edge_cases(void) {
     TEST_ASSERT_TRUE(bits_btn_is_buffer_empty());
 
     printf("缓冲区边界情况测试通过\n");
-}
\ No newline at end of file
+}
+
+void test_snapshot_without_consuming_events(void) {
+    printf("\n=== 测试按键状态快照 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    bits_btn_snapshot_t snapshot;
+
+    // 按下后, 消抖完成前只有原始状态变化
+    mock_button_press(2);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    TEST_ASSERT_EQUAL(1, bits_button_get_snapshot(&snapshot));
+    TEST_ASSERT_EQUAL_UINT32(0x2, snapshot.raw_mask);
+    TEST_ASSERT_EQUAL_UINT32(0x0, snapshot.pressed_mask);
+
+    // 消抖完成后按下状态与按键状态一并发布
+    time_simulate_debounce_delay();
+    time_simulate_long_press_threshold();
+    TEST_ASSERT_EQUAL(1, bits_button_get_snapshot(&snapshot));
+    TEST_ASSERT_EQUAL_UINT32(0x2, snapshot.pressed_mask);
+    TEST_ASSERT_EQUAL(2, snapshot.btn_cnt);
+    TEST_ASSERT_EQUAL(BTN_STATE_IDLE, snapshot.states[0]);
+    TEST_ASSERT_EQUAL(BTN_STATE_LONG_PRESS, snapshot.states[1]);
+
+    // 读取快照不消费缓冲区中的事件
+    size_t used_count = get_bits_btn_buffer_used_count();
+    TEST_ASSERT_TRUE(used_count > 0);
+    TEST_ASSERT_EQUAL(1, bits_button_get_snapshot(&snapshot));
+    TEST_ASSERT_EQUAL(used_count, get_bits_btn_buffer_used_count());
+
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    TEST_ASSERT_EQUAL(1, bits_button_get_snapshot(&snapshot));
+    TEST_ASSERT_EQUAL_UINT32(0x0, snapshot.pressed_mask);
+
+    printf("按键状态快照测试通过\n");
+}
+
+void test_result_filter_mask(void) {
+    printf("\n=== 测试声明式缓冲区过滤 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    bits_btn_result_t result;
+    while (bits_button_get_key_result(&result)) {
+    }
+
+    // 只保留第2个按键的按下与完成事件
+    bits_btn_set_result_filter_mask(BITS_BTN_EVENT_BIT(BTN_STATE_PRESSED) | BITS_BTN_EVENT_BIT(BTN_STATE_FINISH),
+                                    1U << 1);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+
+    TEST_ASSERT_TRUE(bits_button_get_key_result(&result));
+    TEST_ASSERT_EQUAL(2, result.key_id);
+    TEST_ASSERT_EQUAL(BTN_STATE_PRESSED, result.event);
+    TEST_ASSERT_TRUE(bits_button_get_key_result(&result));
+    TEST_ASSERT_EQUAL(2, result.key_id);
+    TEST_ASSERT_EQUAL(BTN_STATE_FINISH, result.event);
+    TEST_ASSERT_FALSE(bits_button_get_key_result(&result));
+
+    // 过滤只影响缓冲区, 结果回调照常收到全部事件
+    VERIFY_SINGLE_CLICK(1);
+
+    // 恢复默认规则: 所有按键的长按与完成事件
+    bits_btn_set_result_filter_mask(BITS_BTN_DEFAULT_EVENT_MASK, ~(button_mask_type_t)0);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    TEST_ASSERT_TRUE(bits_button_get_key_result(&result));
+    TEST_ASSERT_EQUAL(1, result.key_id);
+    TEST_ASSERT_EQUAL(BTN_STATE_FINISH, result.event);
+
+    printf("声明式缓冲区过滤测试通过\n");
+}
+
+static void buffer_view_click(uint16_t key_id) {
+    mock_button_click(key_id, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+}
+
+void test_buffer_view_zero_copy(void) {
+    printf("\n=== 测试缓冲区零拷贝视图 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    bits_btn_buffer_view_t view;
+    bits_btn_result_t result;
+    size_t capacity = get_bits_btn_buffer_capacity();
+    TEST_ASSERT_FALSE(bits_btn_buffer_acquire_view(&view));
+    TEST_ASSERT_EQUAL(0, view.first_len + view.second_len);
+
+    // 读索引移到缓冲区中部, 使可读区间回绕
+    for (size_t i = 0; i < capacity / 2; i++) {
+        buffer_view_click(1);
+        TEST_ASSERT_TRUE(bits_button_get_key_result(&result));
+    }
+    for (size_t i = 0; i < capacity - 2; i++) {
+        buffer_view_click(i % 2 ? 2 : 1);
+    }
+
+    TEST_ASSERT_TRUE(bits_btn_buffer_acquire_view(&view));
+    TEST_ASSERT_EQUAL(capacity - 2, view.first_len + view.second_len);
+    TEST_ASSERT_NOT_NULL(view.second);
+    TEST_ASSERT_TRUE(view.second_len > 0);
+
+    // 视图按时间顺序排列, 且不消耗事件
+    for (size_t i = 0; i < view.first_len + view.second_len; i++) {
+        const bits_btn_result_t *event = i < view.first_len ? &view.first[i] : &view.second[i - view.first_len];
+        TEST_ASSERT_EQUAL(i % 2 ? 2 : 1, event->key_id);
+        TEST_ASSERT_EQUAL(BTN_STATE_FINISH, event->event);
+    }
+    TEST_ASSERT_EQUAL(capacity - 2, get_bits_btn_buffer_used_count());
+
+    // 释放时一次性消耗全部事件
+    TEST_ASSERT_TRUE(bits_btn_buffer_release_view(&view));
+    TEST_ASSERT_TRUE(bits_btn_is_buffer_empty());
+
+    // 持有视图期间缓冲区溢出, 释放时报告事件被覆盖
+    buffer_view_click(1);
+    TEST_ASSERT_TRUE(bits_btn_buffer_acquire_view(&view));
+    for (size_t i = 0; i < capacity; i++) {
+        buffer_view_click(2);
+    }
+    TEST_ASSERT_FALSE(bits_btn_buffer_release_view(&view));
+    TEST_ASSERT_TRUE(bits_button_get_key_result(&result));
+    TEST_ASSERT_EQUAL(2, result.key_id);
+
+    printf("缓冲区零拷贝视图测试通过\n");
+}
@@ -268,3 +268,63 @@ void test_callback_functions(void) {
     printf("✓ 回调函数测试通过: 所有回调组合都经过验证\n");
 }
 
+
+// ==================== 用户数据与上下文测试 ====================
+
+typedef struct {
+    uint8_t level;          // 模拟GPIO电平
+} user_pin_t;
+
+typedef struct {
+    int finish_count;
+    uint16_t last_key_id;
+} user_app_t;
+
+// 直接通过user_data读取电平, 无需按key_id分支
+static uint8_t user_data_read_button(struct button_obj_t *btn) {
+    return ((const user_pin_t *)btn->user_data)->level;
+}
+
+static void context_result_callback(struct button_obj_t *btn, bits_btn_result_t result) {
+    user_app_t *app = (user_app_t *)bits_button_get_context();
+
+    TEST_ASSERT_NOT_NULL(btn->user_data);
+    if (result.event == BTN_STATE_FINISH) {
+        app->finish_count++;
+        app->last_key_id = result.key_id;
+    }
+}
+
+void test_user_data_and_context(void) {
+    printf("\n=== 测试按键用户数据与引擎上下文 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    user_pin_t pins[2] = {{0}, {0}};
+    user_app_t app = {0};
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT_USER(1, 1, &param, &pins[0]),
+        BITS_BUTTON_INIT_USER(2, 1, &param, &pins[1])
+    };
+
+    // 上下文在初始化前后设置均可, 初始化不会清除
+    bits_button_set_context(&app);
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, 2, NULL, 0,
+                                          user_data_read_button,
+                                          context_result_callback,
+                                          NULL));
+    TEST_ASSERT_EQUAL_PTR(&app, bits_button_get_context());
+    TEST_ASSERT_EQUAL_PTR(&pins[1], buttons[1].user_data);
+
+    pins[1].level = 1;
+    time_simulate_debounce_delay();
+    time_simulate_pass(STANDARD_CLICK_TIME_MS);
+    pins[1].level = 0;
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    TEST_ASSERT_EQUAL(1, app.finish_count);
+    TEST_ASSERT_EQUAL(2, app.last_key_id);
+
+    bits_button_set_context(NULL);
+    printf("按键用户数据与引擎上下文测试通过\n");
+}
@@ -0,0 +1,180 @@
+/* test_keymap_layers.c - 按键映射层测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+#define MENU_KEY_OK                 11
+#define PLAY_KEY_PAUSE              21
+#define LAYER_KEY                   12
+
+static const bits_btn_obj_param_t quick_long_param = {
+    .short_press_time_ms = BITS_BTN_SHORT_TIME_MS,
+    .long_press_start_time_ms = 300,
+    .long_press_period_triger_ms = BITS_BTN_LONG_PRESS_PERIOD_TRIGER_MS,
+    .time_window_time_ms = BITS_BTN_TIME_WINDOW_TIME_MS
+};
+
+// 两个物理按键, 两层映射: 按键2按住时切换到第1层
+static const bits_btn_keymap_entry_t test_keymap[] = {
+    // 第0层
+    BITS_BTN_KEYMAP_KEY(MENU_KEY_OK, NULL),
+    BITS_BTN_KEYMAP_MO(LAYER_KEY, 1),
+    // 第1层
+    BITS_BTN_KEYMAP_KEY(PLAY_KEY_PAUSE, &quick_long_param),
+    BITS_BTN_KEYMAP_MO(LAYER_KEY, 1)
+};
+
+static void keymap_test_init(button_obj_t *buttons, uint16_t cnt) {
+    bits_button_set_keymap(test_keymap, 2);
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, cnt, NULL, 0,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+}
+
+// ==================== 映射层切换测试 ====================
+
+void test_keymap_momentary_layer(void) {
+    printf("\n=== 测试按住切换映射层 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    keymap_test_init(buttons, 2);
+
+    // 第0层: 按键1上报 MENU_KEY_OK
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(MENU_KEY_OK);
+
+    // 按住按键2进入第1层: 按键1上报 PLAY_KEY_PAUSE, 并使用第1层的长按参数
+    test_framework_clear_events();
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    TEST_ASSERT_EQUAL(1, bits_button_get_layer());
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    VERIFY_LONG_PRESS_START(PLAY_KEY_PAUSE);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    TEST_ASSERT_EQUAL(0, bits_button_get_layer());
+    ASSERT_EVENT_NOT_EXISTS(MENU_KEY_OK, BTN_STATE_PRESSED);
+
+    // 松开后回到第0层
+    test_framework_clear_events();
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(MENU_KEY_OK);
+
+    bits_button_set_keymap(NULL, 0);
+    printf("按住切换映射层测试通过\n");
+}
+
+void test_keymap_layer_latched_per_gesture(void) {
+    printf("\n=== 测试手势内锁定映射层 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static const bits_btn_keymap_entry_t bad_keymap[] = {
+        BITS_BTN_KEYMAP_KEY(MENU_KEY_OK, NULL),
+        BITS_BTN_KEYMAP_TO(LAYER_KEY, 3)
+    };
+
+    // 切换到不存在的层
+    bits_button_set_keymap(bad_keymap, 1);
+    TEST_ASSERT_EQUAL(-8, bits_button_init(buttons, 2, NULL, 0,
+                                           test_framework_mock_read_button,
+                                           test_framework_event_callback,
+                                           test_framework_log_printf));
+
+    keymap_test_init(buttons, 2);
+
+    // 双击过程中切换层: 整个手势仍按起始层上报
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    bits_button_set_layer(1);
+    time_simulate_pass(100);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_DOUBLE_CLICK(MENU_KEY_OK);
+    ASSERT_EVENT_NOT_EXISTS(PLAY_KEY_PAUSE, BTN_STATE_PRESSED);
+
+    // 新手势使用新层
+    test_framework_clear_events();
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(PLAY_KEY_PAUSE);
+
+    bits_button_set_keymap(NULL, 0);
+    printf("手势内锁定映射层测试通过\n");
+}
+
+// ==================== 运行时参数与映射层测试 ====================
+
+void test_keymap_follows_runtime_param(void) {
+    printf("\n=== 测试映射层使用运行时设置的按键参数 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    keymap_test_init(buttons, 2);
+
+    // 第0层的映射没有单独参数, 跟随按键自身参数: 按住400ms不足以长按
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    ASSERT_EVENT_NOT_EXISTS(MENU_KEY_OK, BTN_STATE_LONG_PRESS);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 运行时切换按键1的参数后, 新手势锁定映射层时不会恢复旧参数
+    TEST_ASSERT_EQUAL(0, bits_button_set_param(1, &quick_long_param));
+    test_framework_clear_events();
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    VERIFY_LONG_PRESS_START(MENU_KEY_OK);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 恢复默认参数, 第1层自带的参数不受影响
+    TEST_ASSERT_EQUAL(0, bits_button_set_param(1, &param));
+    test_framework_clear_events();
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    VERIFY_LONG_PRESS_START(PLAY_KEY_PAUSE);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    test_framework_clear_events();
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    ASSERT_EVENT_NOT_EXISTS(MENU_KEY_OK, BTN_STATE_LONG_PRESS);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    bits_button_set_keymap(NULL, 0);
+    printf("映射层使用运行时设置的按键参数测试通过\n");
+}
@@ -0,0 +1,161 @@
+/* test_priority_keys.c - 优先按键测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+#define PRIORITY_KEY                1
+#define PRIORITY_RELEASE_DEBOUNCE_MS 20
+
+static const bits_btn_priority_key_t test_priority_keys[] = {
+    BITS_BTN_PRIORITY_KEY_INIT(PRIORITY_KEY, 0, PRIORITY_RELEASE_DEBOUNCE_MS)   // 按下不消抖, 松开消抖20ms
+};
+
+static bits_btn_result_t fast_events[16];
+static int fast_event_count = 0;
+
+static void fast_event_callback(struct button_obj_t *btn, bits_btn_result_t result) {
+    (void)btn;
+    if (fast_event_count < (int)ARRAY_SIZE(fast_events)) {
+        fast_events[fast_event_count++] = result;
+    }
+}
+
+static void priority_test_init(button_obj_t *buttons, uint16_t cnt) {
+    fast_event_count = 0;
+    bits_button_set_priority_keys(test_priority_keys, ARRAY_SIZE(test_priority_keys), fast_event_callback);
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, cnt, NULL, 0,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+}
+
+// ==================== 优先按键测试 ====================
+
+void test_priority_key_bypasses_debounce(void) {
+    printf("\n=== 测试优先按键绕过全局消抖 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    priority_test_init(buttons, 2);
+
+    // 其他按键持续抖动, 全局消抖窗口不断重启
+    mock_button_bounce(2, 2, 10);
+    mock_button_press(2);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+
+    // 优先按键在下一个tick立即上报到快速回调
+    mock_button_press(PRIORITY_KEY);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    TEST_ASSERT_EQUAL(1, fast_event_count);
+    TEST_ASSERT_EQUAL(PRIORITY_KEY, fast_events[0].key_id);
+    TEST_ASSERT_EQUAL(BTN_STATE_PRESSED, fast_events[0].event);
+
+    // 优先按键不进入普通状态机和结果回调
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    ASSERT_EVENT_NOT_EXISTS(PRIORITY_KEY, BTN_STATE_PRESSED);
+    TEST_ASSERT_EQUAL(1, fast_event_count);
+
+    mock_button_release(PRIORITY_KEY);
+    time_simulate_debounce_delay();
+    bits_button_set_priority_keys(NULL, 0, NULL);
+    printf("优先按键绕过全局消抖测试通过\n");
+}
+
+void test_priority_key_release_debounce(void) {
+    printf("\n=== 测试优先按键独立松开消抖 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static const bits_btn_priority_key_t bad_priority_keys[] = {
+        BITS_BTN_PRIORITY_KEY_INIT(9, 0, 0)
+    };
+
+    // 未知按键
+    bits_button_set_priority_keys(bad_priority_keys, 1, fast_event_callback);
+    TEST_ASSERT_EQUAL(-10, bits_button_init(buttons, 2, NULL, 0,
+                                            test_framework_mock_read_button,
+                                            test_framework_event_callback,
+                                            test_framework_log_printf));
+
+    priority_test_init(buttons, 2);
+
+    mock_button_press(PRIORITY_KEY);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    TEST_ASSERT_EQUAL(1, fast_event_count);
+
+    // 短于松开消抖时间的抖动被滤除
+    mock_button_release(PRIORITY_KEY);
+    time_simulate_pass(10);
+    mock_button_press(PRIORITY_KEY);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    TEST_ASSERT_EQUAL(1, fast_event_count);
+
+    // 稳定松开后上报
+    mock_button_release(PRIORITY_KEY);
+    time_simulate_pass(PRIORITY_RELEASE_DEBOUNCE_MS + BITS_BTN_TICKS_INTERVAL);
+    TEST_ASSERT_EQUAL(2, fast_event_count);
+    TEST_ASSERT_EQUAL(BTN_STATE_RELEASE, fast_events[1].event);
+
+    bits_button_set_priority_keys(NULL, 0, NULL);
+    printf("优先按键独立松开消抖测试通过\n");
+}
+
+void test_priority_key_rejected_as_member(void) {
+    printf("\n=== 测试优先按键不能作为组合键/序列/双功能键成员 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static uint16_t member_keys[] = {PRIORITY_KEY, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, member_keys, 2, 1);
+    static bits_btn_sequence_t sequences[] = {
+        BITS_BUTTON_SEQUENCE_INIT(200, member_keys, 2, 500)
+    };
+    static const bits_btn_dual_role_t dual_roles[] = {
+        BITS_BTN_DUAL_ROLE_INIT(PRIORITY_KEY, 300, 200)
+    };
+
+    // 优先按键不经过组合键判定, 作为成员时初始化失败
+    bits_button_set_priority_keys(test_priority_keys, ARRAY_SIZE(test_priority_keys), fast_event_callback);
+    TEST_ASSERT_EQUAL(-10, bits_button_init(buttons, 2, &combo, 1,
+                                            test_framework_mock_read_button,
+                                            test_framework_event_callback,
+                                            test_framework_log_printf));
+
+    // 按键序列
+    bits_button_set_sequences(sequences, ARRAY_SIZE(sequences));
+    TEST_ASSERT_EQUAL(-10, bits_button_init(buttons, 2, NULL, 0,
+                                            test_framework_mock_read_button,
+                                            test_framework_event_callback,
+                                            test_framework_log_printf));
+    bits_button_set_sequences(NULL, 0);
+
+    // 双功能键
+    bits_button_set_dual_roles(dual_roles, ARRAY_SIZE(dual_roles));
+    TEST_ASSERT_EQUAL(-10, bits_button_init(buttons, 2, NULL, 0,
+                                            test_framework_mock_read_button,
+                                            test_framework_event_callback,
+                                            test_framework_log_printf));
+    bits_button_set_dual_roles(NULL, 0);
+
+    // 运行时添加同样被拒绝
+    priority_test_init(buttons, 2);
+    TEST_ASSERT_EQUAL(-2, bits_button_add_combo(&combo));
+
+    bits_button_set_priority_keys(NULL, 0, NULL);
+    printf("优先按键成员检查测试通过\n");
+}
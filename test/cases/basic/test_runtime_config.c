@@ -0,0 +1,230 @@
+/* test_runtime_config.c - 运行时配置变更测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+// ==================== 组合键动态增删测试 ====================
+
+void test_runtime_combo_add_remove(void) {
+    printf("\n=== 测试运行时增删组合键 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param),
+        BITS_BUTTON_INIT(3, 1, &param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 3, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 按键3单击进行中时添加组合键, 其手势不受影响
+    mock_button_click(3, STANDARD_CLICK_TIME_MS);
+    TEST_ASSERT_EQUAL(0, bits_button_add_combo(&combo));
+    TEST_ASSERT_EQUAL(-1, bits_button_add_combo(&combo));   // 排队中的组合键也不能重复添加
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(3);
+
+    // 组合键生效: 单键被抑制
+    test_framework_clear_events();
+    mock_button_press(1);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(100);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(100);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_PRESSED);
+    TEST_ASSERT_EQUAL(-1, bits_button_add_combo(&combo));   // 重复添加
+
+    // 移除后恢复为单键事件
+    TEST_ASSERT_EQUAL(0, bits_button_remove_combo(100));
+    time_simulate_pass(10);
+    test_framework_clear_events();
+    mock_button_press(1);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(100);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(1);
+    VERIFY_SINGLE_CLICK(2);
+    ASSERT_EVENT_NOT_EXISTS(100, BTN_STATE_PRESSED);
+
+    printf("运行时增删组合键测试通过\n");
+}
+
+void test_runtime_config_queued_changes(void) {
+    printf("\n=== 测试排队中的运行时配置变更 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    static const bits_btn_obj_param_t quick_long_param = {
+        .short_press_time_ms = BITS_BTN_SHORT_TIME_MS,
+        .long_press_start_time_ms = 300,
+        .long_press_period_triger_ms = BITS_BTN_LONG_PRESS_PERIOD_TRIGER_MS,
+        .time_window_time_ms = BITS_BTN_TIME_WINDOW_TIME_MS
+    };
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 同一tick前: 添加、移除、再添加, 按顺序生效, 只保留一份
+    TEST_ASSERT_EQUAL(0, bits_button_add_combo(&combo));
+    TEST_ASSERT_EQUAL(0, bits_button_remove_combo(100));
+    TEST_ASSERT_EQUAL(-1, bits_button_remove_combo(100));
+    TEST_ASSERT_EQUAL(0, bits_button_add_combo(&combo));
+
+    // 尚未生效的组合键也可以设置参数
+    TEST_ASSERT_EQUAL(0, bits_button_set_param(100, &quick_long_param));
+    time_simulate_pass(10);
+    TEST_ASSERT_EQUAL_PTR(&quick_long_param, combo.btn.param);
+
+    mock_button_press(1);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    VERIFY_LONG_PRESS_START(100);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 一次移除即可恢复为单键事件
+    TEST_ASSERT_EQUAL(0, bits_button_remove_combo(100));
+    time_simulate_pass(10);
+    test_framework_clear_events();
+    mock_button_press(1);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(100);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(1);
+    ASSERT_EVENT_NOT_EXISTS(100, BTN_STATE_PRESSED);
+
+    printf("排队中的运行时配置变更测试通过\n");
+}
+
+// ==================== 参数切换与按键禁用测试 ====================
+
+void test_runtime_param_swap_and_key_disable(void) {
+    printf("\n=== 测试运行时切换参数与禁用按键 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    static const bits_btn_obj_param_t quick_long_param = {
+        .short_press_time_ms = BITS_BTN_SHORT_TIME_MS,
+        .long_press_start_time_ms = 300,
+        .long_press_period_triger_ms = BITS_BTN_LONG_PRESS_PERIOD_TRIGER_MS,
+        .time_window_time_ms = BITS_BTN_TIME_WINDOW_TIME_MS
+    };
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    TEST_ASSERT_EQUAL(-1, bits_button_set_param(9, &quick_long_param));
+    TEST_ASSERT_EQUAL(-2, bits_button_set_param(1, NULL));
+
+    // 切换参数后按住400ms即触发长按
+    TEST_ASSERT_EQUAL(0, bits_button_set_param(1, &quick_long_param));
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(400);
+    VERIFY_LONG_PRESS_START(1);
+    TEST_ASSERT_EQUAL_PTR(&quick_long_param, buttons[0].param);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 禁用按键2: 按下不产生任何事件
+    test_framework_clear_events();
+    TEST_ASSERT_EQUAL(-1, bits_button_set_key_enabled(9, false));
+    TEST_ASSERT_EQUAL(0, bits_button_set_key_enabled(2, false));
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_NOT_EXISTS(2, BTN_STATE_PRESSED);
+
+    // 重新启用后恢复
+    TEST_ASSERT_EQUAL(0, bits_button_set_key_enabled(2, true));
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(2);
+
+    printf("运行时切换参数与禁用按键测试通过\n");
+}
+
+// ==================== 配置接口与tick的数据隔离测试 ====================
+
+void test_runtime_config_producer_isolation(void) {
+    printf("\n=== 测试配置接口不改写tick使用中的数据 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    static const bits_btn_obj_param_t key3_param = TEST_DEFAULT_PARAM();
+    static bits_btn_obj_param_t extra_params[BITS_BTN_MAX_PARAM_SETS - 1];
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param),
+        BITS_BUTTON_INIT(3, 1, &key3_param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 3, &combo, 1,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    time_simulate_pass(10);
+    TEST_ASSERT_EQUAL_HEX32(0x3, combo.combo_mask);
+
+    // 移除后以不同成员重新添加: tick应用之前, 组合键对象保持原样
+    combo_keys[1] = 3;
+    TEST_ASSERT_EQUAL(0, bits_button_remove_combo(100));
+    TEST_ASSERT_EQUAL(0, bits_button_add_combo(&combo));
+    TEST_ASSERT_EQUAL_HEX32(0x3, combo.combo_mask);
+    time_simulate_pass(10);
+    TEST_ASSERT_EQUAL_HEX32(0x5, combo.combo_mask);
+
+    // 参数表由tick追加, 排队中的新参数已占用表项(初始化时已有2组参数)
+    for (int i = 0; i < BITS_BTN_MAX_PARAM_SETS - 1; i++) {
+        extra_params[i] = param;
+    }
+    for (int i = 0; i < BITS_BTN_MAX_PARAM_SETS - 2; i++) {
+        TEST_ASSERT_EQUAL(0, bits_button_set_param(2, &extra_params[i]));
+    }
+    TEST_ASSERT_EQUAL(-5, bits_button_set_param(2, &extra_params[BITS_BTN_MAX_PARAM_SETS - 2]));
+    TEST_ASSERT_EQUAL(0, bits_button_set_param(1, &extra_params[0]));   // 已排队的参数可以复用
+    TEST_ASSERT_EQUAL_PTR(&param, buttons[0].param);
+    time_simulate_pass(10);
+    TEST_ASSERT_EQUAL_PTR(&extra_params[BITS_BTN_MAX_PARAM_SETS - 3], buttons[1].param);
+    TEST_ASSERT_EQUAL_PTR(&extra_params[0], buttons[0].param);
+
+    combo_keys[1] = 2;
+    printf("配置接口数据隔离测试通过\n");
+}
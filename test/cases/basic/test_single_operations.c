@@ -141,4 +141,43 @@ void test_long_press_hold_event(void) {
     // 验证长按保持事件
     ASSERT_LONG_PRESS_COUNT(1, 1);
     printf("长按保持测试通过\n");
-}
\ No newline at end of file
+}
+
+// ==================== 长按加速连发测试 ====================
+
+void test_long_press_hold_acceleration(void) {
+    printf("\n=== 测试长按加速连发 ===\n");
+
+    // 保持周期从500ms开始，每次缩短100ms，最短100ms
+    static const bits_btn_obj_param_t param = {
+        .long_press_period_triger_ms = 500,
+        .long_press_start_time_ms = BITS_BTN_LONG_PRESS_START_TIME_MS,
+        .short_press_time_ms = BITS_BTN_SHORT_TIME_MS,
+        .time_window_time_ms = BITS_BTN_TIME_WINDOW_TIME_MS,
+        .long_press_period_min_ms = 100,
+        .long_press_period_step_ms = 100
+    };
+
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 长按开始后再保持2000ms
+    // 保持事件累计时间约为 500, 900, 1200, 1400, 1500, ... 1900ms，固定周期时只有3次
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_long_press_threshold();
+    time_simulate_pass(2000);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+
+    ASSERT_LONG_PRESS_COUNT(1, 9);
+
+    // 保持事件的触发计数应连续递增
+    bits_btn_result_t *last_hold = assert_find_last_event(1, BTN_STATE_LONG_PRESS);
+    TEST_ASSERT_NOT_NULL(last_hold);
+    TEST_ASSERT_EQUAL_UINT16(9, last_hold->long_press_period_trigger_cnt);
+    printf("长按加速连发测试通过\n");
+}
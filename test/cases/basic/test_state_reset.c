@@ -89,14 +89,14 @@ void test_combo_button_reset(void) {
     combo_button.btn.current_state = BTN_STATE_PRESSED;
     combo_button.btn.last_state = BTN_STATE_PRESSED;
     combo_button.btn.state_bits = 0x5;  // 设置一些状态位
-    combo_button.btn.state_entry_time = 1000;
+    combo_button.btn.next_deadline = 1000;
     combo_button.btn.long_press_period_trigger_cnt = 2;
     
     // 验证状态确实被设置了
     TEST_ASSERT_EQUAL_INT(BTN_STATE_PRESSED, combo_button.btn.current_state);
     TEST_ASSERT_EQUAL_INT(BTN_STATE_PRESSED, combo_button.btn.last_state);
     TEST_ASSERT_EQUAL_INT(0x5, combo_button.btn.state_bits);
-    TEST_ASSERT_EQUAL_INT(1000, combo_button.btn.state_entry_time);
+    TEST_ASSERT_EQUAL_INT(1000, combo_button.btn.next_deadline);
     TEST_ASSERT_EQUAL_INT(2, combo_button.btn.long_press_period_trigger_cnt);
     printf("✓ 组合按键状态设置确认\n");
     
@@ -104,6 +104,9 @@ void test_combo_button_reset(void) {
     printf("调用状态重置函数...\n");
     bits_button_reset_states();
     printf("✓ 状态重置函数调用成功\n");
+
+    // 重置在下一次tick开始时生效
+    time_simulate_ticks(1);
     
     // 6. 验证组合按键状态是否被重置
     printf("验证组合按键状态重置结果...\n");
@@ -115,11 +118,170 @@ void test_combo_button_reset(void) {
                                   "组合按键 last_state 应该被重置为 BTN_STATE_IDLE");
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, combo_button.btn.state_bits,
                                   "组合按键 state_bits 应该被重置为 0");
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, combo_button.btn.state_entry_time,
-                                  "组合按键 state_entry_time 应该被重置为 0");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, combo_button.btn.next_deadline,
+                                  "组合按键 next_deadline 应该被重置为 0");
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, combo_button.btn.long_press_period_trigger_cnt,
                                   "组合按键 long_press_period_trigger_cnt 应该被重置为 0");
     
     printf("✓ 组合按键状态重置验证通过\n");
     printf("✓ 组合按键状态重置测试完成\n");
 }
+
+static uint32_t gpio_read_count = 0;
+
+static uint8_t counting_read_button(struct button_obj_t *btn) {
+    gpio_read_count++;
+    return test_framework_mock_read_button(btn);
+}
+
+void test_change_notification_skips_idle_scan(void) {
+    printf("\n=== 测试引脚变化通知跳过空闲扫描 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     counting_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    bits_button_enable_change_notification(true);
+
+    // 空闲且无通知时不读取GPIO
+    time_simulate_pass(100);
+    gpio_read_count = 0;
+    time_simulate_pass(500);
+    TEST_ASSERT_EQUAL_UINT32(0, gpio_read_count);
+
+    // 中断通知后恢复扫描, 直到按键空闲
+    mock_button_press(1);
+    bits_button_notify_change();
+    time_simulate_debounce_delay();
+    time_simulate_pass(STANDARD_CLICK_TIME_MS);
+    TEST_ASSERT_TRUE(gpio_read_count > 0);
+    mock_button_release(1);
+    bits_button_notify_change();
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(1);
+
+    gpio_read_count = 0;
+    time_simulate_pass(500);
+    TEST_ASSERT_EQUAL_UINT32(0, gpio_read_count);
+
+    bits_button_enable_change_notification(false);
+    printf("引脚变化通知跳过空闲扫描测试通过\n");
+}
+
+static uint8_t reset_in_callback = 0;
+
+// 在tick运行中(结果回调内)请求重置, 模拟与进行中的tick并发调用
+static void reset_during_tick_callback(struct button_obj_t *btn, bits_btn_result_t result) {
+    test_framework_event_callback(btn, result);
+    if (reset_in_callback && result.event == BTN_STATE_FINISH) {
+        reset_in_callback = 0;
+        bits_button_reset_states();
+    }
+}
+
+void test_reset_deferred_to_tick_boundary(void) {
+    printf("\n=== 测试状态重置延迟到tick边界生效 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 长按事件写入缓冲区
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_long_press_threshold();
+    TEST_ASSERT_EQUAL_INT(BTN_STATE_LONG_PRESS, buttons[0].current_state);
+    TEST_ASSERT_FALSE(bits_btn_is_buffer_empty());
+
+    // 调用方不等待tick: 重置前的事件立即对读取端失效, 按键状态保持到下一次tick
+    bits_button_reset_states();
+    TEST_ASSERT_TRUE(bits_btn_is_buffer_empty());
+    TEST_ASSERT_EQUAL_INT(BTN_STATE_LONG_PRESS, buttons[0].current_state);
+
+    // 下一次tick开始时应用重置
+    test_framework_clear_events();
+    time_simulate_ticks(1);
+    TEST_ASSERT_EQUAL_INT(BTN_STATE_IDLE, buttons[0].current_state);
+
+    // 重置后的新事件照常写入缓冲区
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(1);
+    TEST_ASSERT_FALSE(bits_btn_is_buffer_empty());
+
+    // 进行中的tick在请求重置之后又写入了重置前的事件, 读取端同样丢弃
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     reset_during_tick_callback,
+                     test_framework_log_printf);
+    mock_button_press(1);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(STANDARD_CLICK_TIME_MS);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+
+    test_framework_clear_events();
+    reset_in_callback = 1;
+    while (reset_in_callback) {
+        time_simulate_ticks(1);
+    }
+    TEST_ASSERT_EQUAL(2, test_framework_get_event_count());   // 同一tick内两个按键的FINISH
+    bits_btn_result_t result;
+    TEST_ASSERT_FALSE(bits_button_get_key_result(&result));
+    time_simulate_ticks(1);
+    TEST_ASSERT_TRUE(bits_btn_is_buffer_empty());
+
+    printf("状态重置延迟到tick边界生效测试通过\n");
+}
+
+void test_reset_drops_deferred_events(void) {
+    printf("\n=== 测试状态重置丢弃延迟回调队列中的事件 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    bits_button_set_deferred_callbacks(true);
+    bits_btn_result_t result;
+
+    // tick已将单击的事件入队, 线程尚未处理
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+
+    // 重置后队列中的旧手势不再回调, 缓冲区中的旧事件也不可读
+    bits_button_reset_states();
+    TEST_ASSERT_EQUAL(0, bits_button_process());
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+    TEST_ASSERT_TRUE(bits_btn_is_buffer_empty());
+
+    // 应用重置之后的新手势照常回调
+    time_simulate_ticks(1);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    TEST_ASSERT_EQUAL(3, bits_button_process());
+    VERIFY_SINGLE_CLICK(1);
+
+    bits_button_set_deferred_callbacks(false);
+    while (bits_button_get_key_result(&result)) {
+    }
+    printf("状态重置丢弃延迟回调队列事件测试通过\n");
+}
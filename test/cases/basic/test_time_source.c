@@ -0,0 +1,274 @@
+/* test_time_source.c - 外部时间源测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+// ==================== 模拟时间源 ====================
+
+static uint32_t fake_clock_us = 0;
+
+static uint32_t fake_time_source_us(void) {
+    return fake_clock_us;
+}
+
+/**
+ * @brief 以不规则的间隔推进时钟并调用ticks
+ * @param duration_ms 推进的总时间（毫秒）
+ */
+static void run_irregular_ticks(uint32_t duration_ms) {
+    static const uint32_t steps_ms[] = {2, 17, 5, 31, 9};
+    static uint32_t step_index = 0;
+    uint32_t elapsed = 0;
+
+    while (elapsed < duration_ms) {
+        uint32_t step = steps_ms[step_index++ % ARRAY_SIZE(steps_ms)];
+        fake_clock_us += step * 1000;
+        elapsed += step;
+        bits_button_ticks();
+    }
+}
+
+/**
+ * @brief 以固定的较长间隔推进时钟并调用ticks
+ * @param duration_ms 推进的总时间（毫秒）
+ * @param period_ms ticks调用周期（毫秒）
+ */
+static void run_lazy_ticks(uint32_t duration_ms, uint32_t period_ms) {
+    for (uint32_t elapsed = 0; elapsed < duration_ms; elapsed += period_ms) {
+        fake_clock_us += period_ms * 1000;
+        bits_button_ticks();
+    }
+}
+
+// ==================== 不规则tick测试 ====================
+
+void test_time_source_irregular_ticks(void) {
+    printf("\n=== 测试外部时间源(不规则tick) ===\n");
+
+    // 时钟接近回绕点，验证截止时间比较的回绕安全性
+    fake_clock_us = 0xFFF00000u;
+    bits_button_set_time_source(fake_time_source_us, 1000);
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    int32_t result = bits_button_init(&button, 1, NULL, 0,
+                                      test_framework_mock_read_button,
+                                      test_framework_event_callback,
+                                      test_framework_log_printf);
+    TEST_ASSERT_EQUAL_INT32(0, result);
+
+    // 按住900ms：按实际时间计算，尚未达到长按
+    mock_button_press(1);
+    run_irregular_ticks(900);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_PRESSED);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_LONG_PRESS);
+
+    // 再按住200ms：超过长按起始时间
+    run_irregular_ticks(200);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_LONG_PRESS, BITS_BTN_LONG_PRESEE_START_KV);
+
+    mock_button_release(1);
+    run_irregular_ticks(500);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_FINISH);
+
+    bits_button_set_time_source(NULL, 0);
+    printf("外部时间源不规则tick测试通过\n");
+}
+
+// ==================== 低频tick测试 ====================
+
+void test_time_source_lazy_ticks(void) {
+    printf("\n=== 测试外部时间源(低频tick) ===\n");
+
+    fake_clock_us = 0;
+    bits_button_set_time_source(fake_time_source_us, 1000);
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 100ms周期调用ticks，单击后按实际时间等待时间窗口结束
+    mock_button_press(1);
+    run_lazy_ticks(300, 100);
+    mock_button_release(1);
+    run_lazy_ticks(300, 100);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_FINISH);
+
+    // 按tick计数需要60多次调用(约6秒)，按实际时间只需再等几个周期
+    run_lazy_ticks(400, 100);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+
+    bits_button_set_time_source(NULL, 0);
+    printf("外部时间源低频tick测试通过\n");
+}
+
+void test_time_source_release_window(void) {
+    printf("\n=== 测试外部时间源(时间窗口起点) ===\n");
+
+    fake_clock_us = 0;
+    bits_button_set_time_source(fake_time_source_us, 1000);
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    mock_button_press(1);
+    run_lazy_ticks(200, 1);
+    mock_button_release(1);
+
+    // 1ms周期调用ticks, 记录松开与完成事件的时间
+    uint32_t release_ms = 0;
+    uint32_t finish_ms = 0;
+    for (uint32_t ms = 0; ms < 1000 && finish_ms == 0; ms++) {
+        int before = test_framework_get_event_count();
+        run_lazy_ticks(1, 1);
+        for (int i = before; i < test_framework_get_event_count(); i++) {
+            if (test_framework_get_events()[i].event == BTN_STATE_RELEASE)
+                release_ms = fake_clock_us / 1000;
+            if (test_framework_get_events()[i].event == BTN_STATE_FINISH)
+                finish_ms = fake_clock_us / 1000;
+        }
+    }
+
+    // 时间窗口从松开算起, 不再按固定的BITS_BTN_TICKS_INTERVAL加宽
+    TEST_ASSERT_NOT_EQUAL(0, release_ms);
+    TEST_ASSERT_NOT_EQUAL(0, finish_ms);
+    TEST_ASSERT_UINT32_WITHIN(2, BITS_BTN_TIME_WINDOW_TIME_MS, finish_ms - release_ms);
+
+    bits_button_set_time_source(NULL, 0);
+    printf("外部时间源时间窗口起点测试通过\n");
+}
+
+// ==================== 过期截止时间测试 ====================
+
+void test_time_source_stale_debounce_deadline(void) {
+    printf("\n=== 测试外部时间源(过期的消抖截止时间) ===\n");
+
+    // 时间源起点超过2^31, 未设置过的消抖截止时间不能被当作将来的时间
+    fake_clock_us = 0x90000000u;
+    bits_button_set_time_source(fake_time_source_us, 1000);
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    bits_button_enable_change_notification(true);
+
+    uint32_t deadline;
+    run_lazy_ticks(10, 5);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    mock_button_press(1);
+    bits_button_notify_change();
+    run_lazy_ticks(100, 5);
+    mock_button_release(1);
+    bits_button_notify_change();
+    run_lazy_ticks(500, 5);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    // 空闲超过2^31个时间单位后, 上一次的截止时间同样不再参与比较
+    fake_clock_us += 0x80000000u + 12345u;
+    run_lazy_ticks(10, 5);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    test_framework_clear_events();
+    mock_button_press(1);
+    bits_button_notify_change();
+    run_lazy_ticks(100, 5);
+    mock_button_release(1);
+    bits_button_notify_change();
+    run_lazy_ticks(500, 5);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+
+    bits_button_enable_change_notification(false);
+    bits_button_set_time_source(NULL, 0);
+    printf("外部时间源过期消抖截止时间测试通过\n");
+}
+
+// ==================== 批量采样测试 ====================
+
+void test_time_source_sample_batch(void) {
+    printf("\n=== 测试批量采样输入 ===\n");
+
+    static button_mask_type_t samples[800];    // 1kHz采样, 共800ms
+
+    fake_clock_us = 0;
+    bits_button_set_time_source(fake_time_source_us, 1000);
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 前3ms抖动, 随后按住约100ms再松开
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        samples[i] = (i >= 10 && i < 110) ? 1 : 0;
+    }
+    samples[3] = 1;
+    samples[5] = 1;
+
+    // 整批采样以当前时间结束, 一次调用完成消抖与状态机
+    fake_clock_us += ARRAY_SIZE(samples) * 1000;
+    bits_button_feed_samples(samples, ARRAY_SIZE(samples), 1000);
+    ASSERT_EVENT_COUNT(1, BTN_STATE_PRESSED, 1);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+
+    // 无按键变化的批次不产生事件
+    test_framework_clear_events();
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        samples[i] = 0;
+    }
+    fake_clock_us += ARRAY_SIZE(samples) * 1000;
+    bits_button_feed_samples(samples, ARRAY_SIZE(samples), 1000);
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+    TEST_ASSERT_EQUAL(fake_clock_us, bits_button_get_time());
+
+    bits_button_set_time_source(NULL, 0);
+    printf("批量采样输入测试通过\n");
+}
+
+void test_sample_batch_whole_ticks(void) {
+    printf("\n=== 测试无时间源的批量采样周期 ===\n");
+
+    static button_mask_type_t samples[200];    // 每个tick一个采样, 共1s
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 采样周期以tick为单位, 不足一个tick的周期无法表示, 被拒绝且不推进时间
+    uint32_t start = bits_button_get_time();
+    TEST_ASSERT_EQUAL(-2, bits_button_feed_samples(samples, ARRAY_SIZE(samples), 0));
+    TEST_ASSERT_EQUAL(-2, bits_button_feed_samples(NULL, ARRAY_SIZE(samples), 1));
+    TEST_ASSERT_EQUAL(0, bits_button_feed_samples(samples, 0, 1));
+    TEST_ASSERT_EQUAL_UINT32(start, bits_button_get_time());
+
+    // 按住20个tick(100ms)后松开, 其后留出时间窗口
+    for (size_t i = 0; i < ARRAY_SIZE(samples); i++) {
+        samples[i] = (i >= 10 && i < 30) ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL(0, bits_button_feed_samples(samples, ARRAY_SIZE(samples), 1));
+    TEST_ASSERT_EQUAL_UINT32(start + ARRAY_SIZE(samples), bits_button_get_time());
+    ASSERT_EVENT_COUNT(1, BTN_STATE_PRESSED, 1);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+
+    printf("无时间源的批量采样周期测试通过\n");
+}
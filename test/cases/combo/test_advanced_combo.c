@@ -6,6 +6,7 @@
 #include "utils/assert_utils.h"
 #include "config/test_config.h"
 #include "bits_button.h"
+#include <string.h>
 
 // ==================== 测试设置和清理 ====================
 
@@ -177,3 +178,265 @@ void test_multiple_combos_conflict(void) {
     printf("多组合键冲突测试通过: 不同组合键正确识别\n");
 }
 
+
+// ==================== 组合键判定窗口测试 ====================
+
+void test_combo_term_retracts_member_press(void) {
+    printf("\n=== 测试组合键判定窗口撤回单键事件 ===\n");
+#if BITS_BTN_COMBO_TERM_MS > 0
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 2, &combo, 1,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 按键1先于按键2完成消抖, 按键2在判定窗口内按下
+    mock_button_press(1);
+    time_simulate_pass(50);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(200);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 按键1的按下事件被撤回, 只上报组合键
+    ASSERT_EVENT_EXISTS(100, BTN_STATE_PRESSED);
+    ASSERT_EVENT_WITH_VALUE(100, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_PRESSED);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_RELEASE);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_FINISH);
+    printf("组合键判定窗口测试通过: 先到的单键事件被撤回\n");
+#else
+    TEST_IGNORE_MESSAGE("需要定义 BITS_BTN_COMBO_TERM_MS");
+#endif
+}
+
+void test_combo_term_releases_solo_press(void) {
+    printf("\n=== 测试组合键判定窗口超时释放单键事件 ===\n");
+#if BITS_BTN_COMBO_TERM_MS > 0
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 2, &combo, 1,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 单独按住按键1: 判定窗口内事件被暂存
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_PRESSED);
+
+    // 窗口超时后按原顺序上报
+    time_simulate_pass(BITS_BTN_COMBO_TERM_MS + 10);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_PRESSED);
+
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    ASSERT_EVENT_NOT_EXISTS(100, BTN_STATE_PRESSED);
+    printf("组合键判定窗口测试通过: 超时后单键事件正常上报\n");
+#else
+    TEST_IGNORE_MESSAGE("需要定义 BITS_BTN_COMBO_TERM_MS");
+#endif
+}
+
+void test_combo_term_finishes_interrupted_click(void) {
+    printf("\n=== 测试组合键判定窗口撤回时结束前一手势 ===\n");
+#if BITS_BTN_COMBO_TERM_MS > 0
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+
+    bits_button_init(buttons, 2, &combo, 1,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 先单击按键1, 在其时间窗口内按下组合键
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_RELEASE);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_FINISH);
+
+    // 按键1再次按下并先完成消抖, 按键2在判定窗口内按下
+    mock_button_press(1);
+    time_simulate_pass(50);
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    time_simulate_pass(100);
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 被撤回的只有组合键中的按下, 之前的单击仍以FINISH结束
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    ASSERT_EVENT_COUNT(1, BTN_STATE_FINISH, 1);
+    ASSERT_EVENT_COUNT(1, BTN_STATE_PRESSED, 1);
+    ASSERT_EVENT_WITH_VALUE(100, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    printf("组合键判定窗口测试通过: 被打断的单击正常结束\n");
+#else
+    TEST_IGNORE_MESSAGE("需要定义 BITS_BTN_COMBO_TERM_MS");
+#endif
+}
+
+// ==================== 批量回调测试 ====================
+
+#define BATCH_TEST_MAX  16
+
+static bits_btn_result_t batch_events[BATCH_TEST_MAX][BITS_BTN_BATCH_SIZE];
+static size_t batch_sizes[BATCH_TEST_MAX];
+static int batch_count = 0;
+
+static void batch_callback(const bits_btn_result_t *events, size_t n) {
+    if (batch_count < BATCH_TEST_MAX) {
+        memcpy(batch_events[batch_count], events, n * sizeof(events[0]));
+        batch_sizes[batch_count++] = n;
+    }
+}
+
+void test_batch_callback_combos_first(void) {
+    printf("\n=== 测试每tick批量回调 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param),
+        BITS_BUTTON_INIT(3, 1, &param)
+    };
+
+    // 不抑制单键事件, 组合键与单键在同一tick上报
+    static uint16_t combo_keys[] = {1, 2};
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 0);
+
+    bits_button_init(buttons, 3, &combo, 1,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    batch_count = 0;
+    bits_button_set_batch_callback(batch_callback);
+
+    mock_set_button_state(3, 1);
+    mock_set_button_state(1, 1);
+    mock_set_button_state(2, 1);
+    time_simulate_debounce_delay();
+    mock_set_button_state(1, 0);
+    mock_set_button_state(2, 0);
+    mock_set_button_state(3, 0);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    // 逐事件的结果回调不再被调用
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+    TEST_ASSERT_TRUE(batch_count > 0);
+
+    // 同一tick的事件一次交付: 组合键事件在前, 单键事件在后
+    int combo_press_batch = -1;
+    for (int i = 0; i < batch_count; i++) {
+        int singles_started = 0;
+        for (size_t j = 0; j < batch_sizes[i]; j++) {
+            if (batch_events[i][j].key_id == 100) {
+                TEST_ASSERT_FALSE(singles_started);
+                if (batch_events[i][j].event == BTN_STATE_PRESSED) {
+                    combo_press_batch = i;
+                }
+            } else {
+                singles_started = 1;
+            }
+        }
+    }
+    TEST_ASSERT_NOT_EQUAL(-1, combo_press_batch);
+    TEST_ASSERT_TRUE(batch_sizes[combo_press_batch] > 1);
+    TEST_ASSERT_EQUAL(100, batch_events[combo_press_batch][0].key_id);
+
+    // 取消批量回调后恢复逐事件回调
+    bits_button_set_batch_callback(NULL);
+    mock_button_click(3, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(3);
+
+    printf("每tick批量回调测试通过: 共%d批\n", batch_count);
+}
+
+static uint8_t processing = 0;
+static uint8_t ticking = 0;
+static int batch_calls_in_tick = 0;
+static int batch_events_total = 0;
+
+static void deferred_batch_callback(const bits_btn_result_t *events, size_t n) {
+    (void)events;
+    if (ticking) {
+        batch_calls_in_tick++;
+    }
+    batch_events_total += (int)n;
+}
+
+// 在bits_button_process()处理事件的中途(逐事件调试输出处)运行tick, 模拟tick中断打断线程上下文
+static int tick_during_process_printf(const char *format, ...) {
+    if (processing && !ticking && strncmp(format, "key id", 6) == 0) {
+        ticking = 1;
+        bits_button_ticks();
+        ticking = 0;
+    }
+    return 0;
+}
+
+void test_batch_callback_deferred_mode(void) {
+    printf("\n=== 测试延迟回调模式下的批量回调 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     tick_during_process_printf);
+    bits_button_set_deferred_callbacks(true);
+    bits_button_set_batch_callback(deferred_batch_callback);
+    batch_calls_in_tick = 0;
+    batch_events_total = 0;
+
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    TEST_ASSERT_EQUAL(0, batch_events_total);
+
+    // 处理过程中到来的tick只入队事件, 暂存的批次由bits_button_process()交付
+    processing = 1;
+    uint16_t handled = bits_button_process();
+    processing = 0;
+
+    TEST_ASSERT_EQUAL(0, batch_calls_in_tick);
+    TEST_ASSERT_EQUAL(handled, batch_events_total);
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+
+    bits_button_set_batch_callback(NULL);
+    bits_button_set_deferred_callbacks(false);
+    bits_btn_result_t result;
+    while (bits_button_get_key_result(&result)) {
+    }
+    printf("延迟回调模式下的批量回调测试通过: 共%d个事件\n", batch_events_total);
+}
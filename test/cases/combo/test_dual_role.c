@@ -0,0 +1,134 @@
+/* test_dual_role.c - 单击/长按双功能键测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+#define DUAL_ROLE_HOLD_KEY          60   // 按键1按住时作为修饰键上报的键值
+#define DUAL_ROLE_HOLD_TIME_MS      300
+
+static const bits_btn_dual_role_t test_dual_roles[] = {
+    BITS_BTN_DUAL_ROLE_INIT(1, DUAL_ROLE_HOLD_KEY, DUAL_ROLE_HOLD_TIME_MS)
+};
+
+static void dual_role_test_init(button_obj_t *buttons, uint16_t cnt) {
+    bits_button_set_dual_roles(test_dual_roles, ARRAY_SIZE(test_dual_roles));
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, cnt, NULL, 0,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+}
+
+// 事件在上报顺序中的位置, 不存在时返回-1
+static int find_event_index(uint16_t key_id, uint8_t event_type) {
+    bits_btn_result_t *events = test_framework_get_events();
+
+    for (int i = 0; i < test_framework_get_event_count(); i++) {
+        if (events[i].key_id == key_id && events[i].event == event_type) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ==================== 双功能键判定测试 ====================
+
+void test_dual_role_tap_and_hold_time(void) {
+    printf("\n=== 测试双功能键单击与按住超时判定 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    static const bits_btn_dual_role_t bad_dual_roles[] = {
+        BITS_BTN_DUAL_ROLE_INIT(9, DUAL_ROLE_HOLD_KEY, DUAL_ROLE_HOLD_TIME_MS)
+    };
+
+    // 未知按键
+    bits_button_set_dual_roles(bad_dual_roles, 1);
+    TEST_ASSERT_EQUAL(-9, bits_button_init(buttons, 2, NULL, 0,
+                                           test_framework_mock_read_button,
+                                           test_framework_event_callback,
+                                           test_framework_log_printf));
+
+    dual_role_test_init(buttons, 2);
+
+    // 先松开: 判定为单击, 按原键值上报
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    VERIFY_SINGLE_CLICK(1);
+    ASSERT_EVENT_NOT_EXISTS(DUAL_ROLE_HOLD_KEY, BTN_STATE_PRESSED);
+
+    // 未判定前不上报任何事件
+    test_framework_clear_events();
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    time_simulate_pass(100);
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+
+    // 按住超过判定时间: 判定为按住, 整个手势按修饰键键值上报
+    time_simulate_pass(DUAL_ROLE_HOLD_TIME_MS);
+    ASSERT_EVENT_EXISTS(DUAL_ROLE_HOLD_KEY, BTN_STATE_PRESSED);
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    ASSERT_EVENT_EXISTS(DUAL_ROLE_HOLD_KEY, BTN_STATE_RELEASE);
+    TEST_ASSERT_EQUAL(NULL, assert_find_event(1, BTN_STATE_PRESSED));
+
+    bits_button_set_dual_roles(NULL, 0);
+    printf("双功能键单击与按住超时判定测试通过\n");
+}
+
+void test_dual_role_permissive_hold(void) {
+    printf("\n=== 测试双功能键提前判定按住 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    dual_role_test_init(buttons, 2);
+
+    // 按住按键1期间按下并松开按键2: 不等超时, 立即判定为按住
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+
+    // 修饰键先于按键2上报
+    TEST_ASSERT_NOT_EQUAL(-1, find_event_index(DUAL_ROLE_HOLD_KEY, BTN_STATE_PRESSED));
+    TEST_ASSERT_TRUE(find_event_index(DUAL_ROLE_HOLD_KEY, BTN_STATE_PRESSED) <
+                     find_event_index(2, BTN_STATE_PRESSED));
+
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    ASSERT_EVENT_EXISTS(DUAL_ROLE_HOLD_KEY, BTN_STATE_RELEASE);
+    VERIFY_SINGLE_CLICK(2);
+
+    // 按键2按下后按键1先松开(快速连按): 判定为单击, 按键1先于按键2上报
+    test_framework_clear_events();
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    mock_button_press(2);
+    time_simulate_debounce_delay();
+    mock_button_release(1);
+    time_simulate_debounce_delay();
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    ASSERT_EVENT_NOT_EXISTS(DUAL_ROLE_HOLD_KEY, BTN_STATE_PRESSED);
+    VERIFY_SINGLE_CLICK(1);
+    VERIFY_SINGLE_CLICK(2);
+    TEST_ASSERT_TRUE(find_event_index(1, BTN_STATE_PRESSED) < find_event_index(2, BTN_STATE_PRESSED));
+
+    bits_button_set_dual_roles(NULL, 0);
+    printf("双功能键提前判定按住测试通过\n");
+}
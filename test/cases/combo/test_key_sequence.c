@@ -0,0 +1,113 @@
+/* test_key_sequence.c - 跨按键顺序序列测试 */
+#include "unity.h"
+#include "core/test_framework.h"
+#include "utils/mock_utils.h"
+#include "utils/time_utils.h"
+#include "utils/assert_utils.h"
+#include "config/test_config.h"
+#include "bits_button.h"
+
+#define TEST_SEQUENCE_ABA           500
+#define TEST_SEQUENCE_BC            501
+
+static uint16_t seq_aba_keys[] = {1, 2, 1};
+static uint16_t seq_bc_keys[] = {2, 3};
+
+// ==================== 序列识别测试 ====================
+
+void test_key_sequence_match(void) {
+    printf("\n=== 测试跨按键顺序序列识别 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param),
+        BITS_BUTTON_INIT(3, 1, &param)
+    };
+    bits_btn_sequence_t sequences[] = {
+        BITS_BUTTON_SEQUENCE_INIT(TEST_SEQUENCE_ABA, seq_aba_keys, 3, 1000),
+        BITS_BUTTON_SEQUENCE_INIT(TEST_SEQUENCE_BC, seq_bc_keys, 2, 500)
+    };
+
+    bits_button_set_sequences(sequences, ARRAY_SIZE(sequences));
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, 3, NULL, 0,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+
+    // A -> B -> A
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_pass(100);
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    time_simulate_pass(100);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+
+    ASSERT_EVENT_COUNT(TEST_SEQUENCE_ABA, BTN_STATE_FINISH, 1);
+    ASSERT_EVENT_NOT_EXISTS(TEST_SEQUENCE_BC, BTN_STATE_FINISH);
+
+    // 单键事件照常上报
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_FINISH);
+    ASSERT_EVENT_EXISTS(2, BTN_STATE_FINISH);
+
+    // B -> C
+    test_framework_clear_events();
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    mock_button_click(3, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+
+    ASSERT_EVENT_WITH_VALUE(TEST_SEQUENCE_BC, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    ASSERT_EVENT_NOT_EXISTS(TEST_SEQUENCE_ABA, BTN_STATE_FINISH);
+
+    bits_button_set_sequences(NULL, 0);
+    printf("顺序序列识别测试通过\n");
+}
+
+void test_key_sequence_timeout_and_restart(void) {
+    printf("\n=== 测试顺序序列超时与重新开始 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_btn_sequence_t sequences[] = {
+        BITS_BUTTON_SEQUENCE_INIT(TEST_SEQUENCE_ABA, seq_aba_keys, 3, 1000)
+    };
+    static uint16_t bad_keys[] = {1, 9};
+    bits_btn_sequence_t bad_sequences[] = {
+        BITS_BUTTON_SEQUENCE_INIT(TEST_SEQUENCE_BC, bad_keys, 2, 500)
+    };
+
+    // 序列中包含不存在的按键
+    bits_button_set_sequences(bad_sequences, 1);
+    TEST_ASSERT_EQUAL(-6, bits_button_init(buttons, 2, NULL, 0,
+                                           test_framework_mock_read_button,
+                                           test_framework_event_callback,
+                                           test_framework_log_printf));
+
+    bits_button_set_sequences(sequences, 1);
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, 2, NULL, 0,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+
+    // A 之后超时, B -> A 不构成完整序列
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_pass(1500);
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_NOT_EXISTS(TEST_SEQUENCE_ABA, BTN_STATE_FINISH);
+
+    // A -> A -> B -> A: 第二次 A 重新开始序列
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    mock_button_click(2, STANDARD_CLICK_TIME_MS);
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_COUNT(TEST_SEQUENCE_ABA, BTN_STATE_FINISH, 1);
+
+    bits_button_set_sequences(NULL, 0);
+    printf("顺序序列超时测试通过\n");
+}
@@ -0,0 +1,129 @@
+// C++20 协程测试
+// 验证 co_await engine.next_event() / next_gesture() 由tick驱动按顺序恢复
+
+#include "bits_button.hpp"
+#include <cstdio>
+
+#ifndef BITS_BTN_HAS_COROUTINES
+#error "需要支持协程的C++20编译器"
+#endif
+
+struct UnlockConfig : bits::DefaultConfig {
+    static constexpr std::array<bits::Key, 2> keys{{{1}, {2}}};
+};
+
+using UnlockEngine = bits::Engine<2, 0, UnlockConfig>;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::printf("❌ 检查失败: %s (第%d行)\n", #cond, __LINE__);      \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static int unlock_step = 0;
+static int events_seen = 0;
+
+// 先双击再长按按键1才解锁, 其间的其他操作被忽略
+static bits::Task unlock_flow(UnlockEngine &engine)
+{
+    co_await engine.next_gesture(1, BITS_BTN_DOUBLE_CLICK_KV);
+    unlock_step = 1;
+    bits_btn_result_t hold = co_await engine.next_gesture(1, BITS_BTN_LONG_PRESEE_START_KV);
+    CHECK(hold.event == BTN_STATE_LONG_PRESS);
+    unlock_step = 2;
+}
+
+static int key2_double_clicks = 0;
+
+static bits::Task wait_key2_double_click(UnlockEngine &engine)
+{
+    co_await engine.next_gesture(2, BITS_BTN_DOUBLE_CLICK_KV);
+    key2_double_clicks++;
+}
+
+// 任意按键的事件
+static bits::Task count_events(UnlockEngine &engine, int count)
+{
+    for (int i = 0; i < count; i++) {
+        co_await engine.next_event();
+        events_seen++;
+    }
+}
+
+int main()
+{
+    std::printf("BitsButton C++20 协程测试开始...\n");
+
+    uint8_t levels[2] = {0, 0};
+    auto read = [&levels](std::size_t index) { return levels[index]; };
+    auto on_event = [](const bits_btn_result_t &) {};
+
+    UnlockEngine engine;
+    CHECK(engine.start(read, on_event) == 0);
+
+    auto run = [&engine](int ms) {
+        for (int i = 0; i < ms / BITS_BTN_TICKS_INTERVAL; i++)
+            engine.tick();
+    };
+    auto click = [&](std::size_t index) {
+        levels[index] = 1;
+        run(100);
+        levels[index] = 0;
+        run(100);
+    };
+
+    unlock_flow(engine);
+    count_events(engine, 3);
+    CHECK(unlock_step == 0);
+
+    // 1. 单击按键1与按键2不满足条件
+    std::printf("1. 测试不匹配的手势...\n");
+    click(0);
+    run(400);
+    click(1);
+    run(400);
+    CHECK(unlock_step == 0);
+    CHECK(events_seen == 2);
+
+    // 2. 双击按键1后进入下一步
+    std::printf("2. 测试双击...\n");
+    click(0);
+    click(0);
+    run(400);
+    CHECK(unlock_step == 1);
+    CHECK(events_seen == 3);
+
+    // 3. 长按按键1解锁
+    std::printf("3. 测试长按...\n");
+    levels[0] = 1;
+    run(BITS_BTN_LONG_PRESS_START_TIME_MS + 100);
+    CHECK(unlock_step == 2);
+    levels[0] = 0;
+    run(400);
+
+    // 4. 不匹配的事件先于等待的手势到来: 协程照常恢复, 不匹配的事件按顺序暂存供应用读取
+    std::printf("4. 测试不匹配事件不阻塞等待...\n");
+    bits_btn_result_t result;
+    while (engine.next_event(result)) {
+    }
+    wait_key2_double_click(engine);
+    click(0);
+    run(400);
+    click(1);
+    click(1);
+    run(400);
+    CHECK(key2_double_clicks == 1);
+    CHECK(engine.next_event(result));
+    CHECK(result.key_id == 1 && result.event == BTN_STATE_FINISH);
+    CHECK(!engine.next_event(result));
+
+    if (failures == 0) {
+        std::printf("🎉 C++20 协程测试通过！\n");
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,147 @@
+// C++17 前端测试
+// 验证 bits::Engine 的编译期配置检查、处理函数调用与事件读取
+
+#include "bits_button.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+struct PanelConfig : bits::DefaultConfig {
+    static constexpr uint16_t time_window_time_ms = 200;
+    static constexpr std::array<bits::Key, 4> keys{{{1}, {2}, {3}, {4, 0}}};
+    static constexpr std::array<bits::Combo, 2> combos{{
+        bits::Combo(100, {1, 2}),
+        bits::Combo(101, {1, 2, 3})
+    }};
+};
+
+using PanelEngine = bits::Engine<4, 2, PanelConfig>;
+
+// 编译期检查: 组合键掩码、排序与参数
+static_assert(PanelEngine::combo_mask(0) == 0x3, "组合键100由前两个按键组成");
+static_assert(PanelEngine::combo_mask(1) == 0x7, "组合键101由前三个按键组成");
+static_assert(PanelEngine::combo_order[0] == 1 && PanelEngine::combo_order[1] == 0, "成员多的组合键在前");
+static_assert(PanelEngine::index_of(4) == 3 && PanelEngine::index_of(9) == -1, "按键位置");
+static_assert(PanelEngine::param.time_window_time_ms == 200, "配置覆盖默认时间窗口");
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::printf("❌ 检查失败: %s (第%d行)\n", #cond, __LINE__);      \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static bool has_event(const std::vector<bits_btn_result_t> &events, uint16_t key_id, uint8_t event)
+{
+    for (const bits_btn_result_t &result : events) {
+        if (result.key_id == key_id && result.event == event)
+            return true;
+    }
+    return false;
+}
+
+int main()
+{
+    std::printf("BitsButton C++17 前端测试开始...\n");
+
+    // 按键4低电平有效, 其余高电平有效
+    uint8_t levels[4] = {0, 0, 0, 1};
+    std::vector<bits_btn_result_t> events;
+
+    auto read = [&levels](std::size_t index) { return levels[index]; };
+    auto on_event = [&events](const bits_btn_result_t &result) { events.push_back(result); };
+
+    PanelEngine engine;
+    CHECK(engine.start(read, on_event) == 0);
+    CHECK(engine.button(3).active_level == 0);
+
+    auto run = [&engine](int ms) {
+        for (int i = 0; i < ms / BITS_BTN_TICKS_INTERVAL; i++)
+            engine.tick();
+    };
+
+    // 1. 单击低电平有效的按键4
+    std::printf("1. 测试单击...\n");
+    levels[3] = 0;
+    run(100);
+    levels[3] = 1;
+    run(400);
+    CHECK(has_event(events, 4, BTN_STATE_FINISH));
+
+    // 2. 组合键: 成员被抑制, 事件可从缓冲区读取
+    std::printf("2. 测试组合键...\n");
+    events.clear();
+    levels[0] = levels[1] = 1;
+    run(100);
+    levels[0] = levels[1] = 0;
+    run(400);
+    CHECK(has_event(events, 100, BTN_STATE_FINISH));
+    CHECK(!has_event(events, 1, BTN_STATE_PRESSED));
+
+    bool buffered = false;
+    bits_btn_result_t result;
+    while (engine.next_event(result)) {
+        if (result.key_id == 100 && result.event == BTN_STATE_FINISH)
+            buffered = true;
+    }
+    CHECK(buffered);
+
+    // 3. 零拷贝视图: STL算法直接遍历缓冲区, 视图销毁时一次消耗
+    std::printf("3. 测试缓冲区视图...\n");
+    for (int i = 0; i < 3; i++) {
+        levels[3] = 0;
+        run(100);
+        levels[3] = 1;
+        run(400);
+    }
+    {
+        auto view = engine.events();
+        CHECK(view.size() == 3);
+        CHECK(std::count_if(view.begin(), view.end(), [](const bits_btn_result_t &r) {
+                  return r.key_id == 4 && r.event == BTN_STATE_FINISH;
+              }) == 3);
+        CHECK(bits_btn_is_buffer_empty() == 0);
+    }
+    CHECK(bits_btn_is_buffer_empty() != 0);
+
+    // 4. 单例引擎: 已启动的Engine存活期间, 另一个Engine无法启动
+    std::printf("4. 测试单例保护...\n");
+    {
+        PanelEngine other;
+        CHECK(other.start(read, on_event) == bits::kEngineBusy);
+    }
+    CHECK(engine.start(read, on_event) == 0);
+
+    // 5. 初始化失败时释放单例, 另一个Engine可以启动
+    std::printf("5. 测试初始化失败...\n");
+    static const bits_btn_priority_key_t unknown_key[] = {BITS_BTN_PRIORITY_KEY_INIT(9, 0, 0)};
+    bits_button_set_priority_keys(unknown_key, 1, nullptr);
+    CHECK(engine.start(read, on_event) == -10);
+    bits_button_set_priority_keys(nullptr, 0, nullptr);
+    {
+        PanelEngine other;
+        CHECK(other.start(read, on_event) == 0);
+    }
+
+    // 6. 处理函数按值保存: 临时lambda与const处理函数
+    std::printf("6. 测试临时处理函数...\n");
+    const auto const_read = read;
+    CHECK(engine.start(const_read, [&events](const bits_btn_result_t &r) { events.push_back(r); }) == 0);
+    events.clear();
+    levels[3] = 0;
+    run(100);
+    levels[3] = 1;
+    run(400);
+    CHECK(has_event(events, 4, BTN_STATE_FINISH));
+    while (engine.next_event(result)) {
+    }
+
+    if (failures == 0) {
+        std::printf("🎉 C++17 前端测试通过！\n");
+        return 0;
+    }
+    return 1;
+}
@@ -104,6 +104,54 @@ void test_very_short_press(void) {
     printf("极短按键测试通过: 被消抖过滤\n");
 }
 
+// ==================== 前沿消抖测试 ====================
+
+void test_eager_debounce(void) {
+    printf("\n=== 测试前沿消抖 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[] = {
+        BITS_BUTTON_EAGER_INIT(1, 1, &param),
+        BITS_BUTTON_INIT(2, 1, &param)
+    };
+    bits_button_init(buttons, 2, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 第一个边沿立即上报, 无需等待消抖时间
+    mock_button_press(1);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_PRESSED);
+
+    // 锁定期内的抖动被忽略
+    mock_button_release(1);
+    time_simulate_pass(5);
+    mock_button_press(1);
+    time_simulate_pass(STANDARD_CLICK_TIME_MS);
+    mock_button_release(1);
+    time_simulate_pass(2 * BITS_BTN_TICKS_INTERVAL);  // 松开边沿 + 状态机上报释放
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_RELEASE);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_COUNT(1, BTN_STATE_PRESSED, 1);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+
+    // 其他按键处于消抖窗口时, 前沿消抖按键不受影响
+    test_framework_clear_events();
+    mock_button_press(2);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    mock_button_press(1);
+    time_simulate_pass(BITS_BTN_TICKS_INTERVAL);
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_PRESSED);
+    ASSERT_EVENT_NOT_EXISTS(2, BTN_STATE_PRESSED);
+
+    mock_button_release(1);
+    mock_button_release(2);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+    printf("前沿消抖测试通过: 首个边沿立即上报, 抖动被锁定期过滤\n");
+}
+
 // ==================== 长按边界测试 ====================
 
 void test_long_press_boundary(void) {
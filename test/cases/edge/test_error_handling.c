@@ -151,6 +151,17 @@ void test_resource_exhaustion(void) {
     
     // 根据实现，可能成功或失败
     printf("超过最大组合按键数量的初始化结果: %d\n", result);
+
+    // 单按键数量超过按键掩码位数时拒绝初始化
+    static button_obj_t many_buttons[BITS_BTN_MAX_KEYS + 1];
+    for (int i = 0; i < BITS_BTN_MAX_KEYS + 1; i++) {
+        many_buttons[i] = (button_obj_t)BITS_BUTTON_INIT(i + 1, 1, &param);
+    }
+    result = bits_button_init(many_buttons, BITS_BTN_MAX_KEYS + 1, NULL, 0,
+                              test_framework_mock_read_button,
+                              test_framework_event_callback,
+                              test_framework_log_printf);
+    TEST_ASSERT_EQUAL(-11, result);
     
     // 测试缓冲区资源耗尽（在buffer_operations.c中已测试）
     printf("资源耗尽测试通过: 正确处理资源限制\n");
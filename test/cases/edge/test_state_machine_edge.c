@@ -163,4 +163,91 @@ void test_rapid_state_changes(void) {
     ASSERT_EVENT_EXISTS(1, BTN_STATE_FINISH);
     
     printf("快速状态变化测试通过: 系统能处理快速状态变化\n");
-}
\ No newline at end of file
+}
+
+void test_click_history_overflow(void) {
+    printf("\n=== 测试连击历史溢出 ===\n");
+
+    // 创建按键对象
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 20连击，超出32位历史所能容纳的长度
+    mock_multiple_clicks(1, 20, 50, 100);
+    time_simulate_time_window_end();
+
+    // 前15次点击作为溢出块上报，剩余5次点击在FINISH中上报，拼接后仍是完整序列
+    ASSERT_EVENT_COUNT(1, BTN_EVENT_HISTORY_OVERFLOW, 1);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_EVENT_HISTORY_OVERFLOW, 0x2AAAAAAA);  // 15 x 0b10
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, 0b1010101010);         // 5 x 0b10
+
+    // 续接块带有块计数, 不会被误认为短手势
+    bits_btn_result_t *events = test_framework_get_events();
+    for (int i = 0; i < test_framework_get_event_count(); i++) {
+        if (events[i].event == BTN_EVENT_HISTORY_OVERFLOW) {
+            TEST_ASSERT_EQUAL(0, events[i].history_chunk);
+        } else if (events[i].event == BTN_STATE_FINISH) {
+            TEST_ASSERT_EQUAL(1, events[i].history_chunk);
+        }
+    }
+
+    // 17连击: 溢出后剩余2次点击的FINISH值等于双击, 只能通过块计数区分
+    test_framework_clear_events();
+    mock_multiple_clicks(1, 17, 50, 100);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_DOUBLE_CLICK_KV);
+    for (int i = 0; i < test_framework_get_event_count(); i++) {
+        if (events[i].event == BTN_STATE_FINISH) {
+            TEST_ASSERT_EQUAL(1, events[i].history_chunk);
+        }
+    }
+
+    // 新手势的块计数从0开始
+    test_framework_clear_events();
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+    TEST_ASSERT_EQUAL(0, events[test_framework_get_event_count() - 1].history_chunk);
+
+    printf("连击历史溢出测试通过: 长序列分块上报无丢失\n");
+}
+
+void test_next_deadline_reporting(void) {
+    printf("\n=== 测试最近截止时间查询 ===\n");
+
+    // 创建按键对象
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    uint32_t deadline = 0;
+
+    // 空闲时没有待处理的截止时间
+    time_simulate_pass(100);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    // 按下并消抖后，截止时间为长按起始时间
+    mock_button_press(1);
+    time_simulate_debounce_delay();
+    ASSERT_EVENT_EXISTS(1, BTN_STATE_PRESSED);
+    TEST_ASSERT_TRUE(bits_button_get_next_deadline(&deadline));
+
+    uint32_t ticks_left = deadline - bits_button_get_time();
+    TEST_ASSERT_TRUE(ticks_left > 0);
+    TEST_ASSERT_TRUE(ticks_left <= TEST_LONG_PRESS_TIME_MS / BITS_BTN_TICKS_INTERVAL + 1);
+
+    // 截止时间前一个tick不应触发长按，到达截止时间时触发
+    time_simulate_ticks(ticks_left - 1);
+    ASSERT_EVENT_NOT_EXISTS(1, BTN_STATE_LONG_PRESS);
+    time_simulate_ticks(1);
+    ASSERT_EVENT_WITH_VALUE(1, BTN_STATE_LONG_PRESS, BITS_BTN_LONG_PRESEE_START_KV);
+
+    printf("最近截止时间查询测试通过\n");
+}
@@ -0,0 +1,151 @@
+/* test_combo_simd.c - 组合键批量判定的向量实现与标量参考实现一致性测试
+ *
+ * 白盒测试: 直接包含 bits_button.c 调用内部判定函数, 由CMake按每种向量实现
+ * (BITS_BTN_DISABLE_SIMD / SSE2 / AVX2 / NEON) 分别编译执行。
+ */
+#include "unity.h"
+#include <stdio.h>
+#include <time.h>
+#include "bits_button.c"
+
+#define SIMD_RANDOM_ROUNDS      2000
+#define SIMD_BENCH_ROUNDS       200000
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t next_random(void) {
+    // xorshift32, 固定种子保证可复现
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * @brief 生成一个2~4个成员的随机组合键掩码
+ */
+static button_mask_type_t random_combo_mask(void) {
+    button_mask_type_t mask = 0;
+    int members = 2 + (int)(next_random() % 3);
+
+    while (members > 0) {
+        button_mask_type_t bit = (button_mask_type_t)1UL << (next_random() % BITS_BTN_MAX_KEYS);
+        if ((mask & bit) == 0) {
+            mask |= bit;
+            members--;
+        }
+    }
+    return mask;
+}
+
+static int simd_path_available(void) {
+#if defined(__AVX2__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return 1;
+#endif
+}
+
+static const char *simd_path_name(void) {
+#if defined(BITS_BTN_SIMD_LANES) && defined(__AVX2__)
+    return "AVX2";
+#elif defined(BITS_BTN_SIMD_LANES) && defined(__SSE2__)
+    return "SSE2";
+#elif defined(BITS_BTN_SIMD_LANES)
+    return "NEON";
+#else
+    return "标量";
+#endif
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ==================== 一致性测试 ====================
+
+void test_combo_simd_matches_scalar(void) {
+    printf("\n=== 测试组合键批量判定一致性(%s) ===\n", simd_path_name());
+    if (!simd_path_available()) {
+        TEST_IGNORE_MESSAGE("当前CPU不支持该向量指令集");
+    }
+
+    button_mask_type_t masks[BITS_BTN_MAX_COMBO_BUTTONS];
+    uint32_t bulk_bits[BITS_BTN_COMBO_BITMAP_WORDS];
+    uint32_t scalar_bits[BITS_BTN_COMBO_BITMAP_WORDS];
+
+    // 覆盖全部组合键数量, 包括不足一组向量宽度的尾部
+    for (uint16_t cnt = 1; cnt <= BITS_BTN_MAX_COMBO_BUTTONS; cnt++) {
+        for (int round = 0; round < SIMD_RANDOM_ROUNDS / 10; round++) {
+            for (uint16_t i = 0; i < cnt; i++) {
+                masks[i] = random_combo_mask();
+            }
+
+            // 一半轮次让当前掩码覆盖部分组合键, 保证有命中
+            button_mask_type_t current = next_random();
+            if (round & 1) {
+                current |= masks[next_random() % cnt];
+            }
+
+            memset(scalar_bits, 0, sizeof(scalar_bits));
+            __get_combo_pressed_bits_scalar(masks, 0, cnt, current, scalar_bits);
+            __get_combo_pressed_bits(masks, cnt, current, bulk_bits);
+
+            TEST_ASSERT_EQUAL_HEX32_ARRAY(scalar_bits, bulk_bits, BITS_BTN_COMBO_BITMAP_WORDS);
+        }
+    }
+
+    printf("组合键批量判定一致性测试通过: 1~%d个组合键\n", BITS_BTN_MAX_COMBO_BUTTONS);
+}
+
+// ==================== 加速比测试 ====================
+
+void test_combo_simd_speedup(void) {
+    printf("\n=== 测试组合键批量判定加速比(%s) ===\n", simd_path_name());
+    if (!simd_path_available()) {
+        TEST_IGNORE_MESSAGE("当前CPU不支持该向量指令集");
+    }
+
+    static button_mask_type_t masks[BITS_BTN_MAX_COMBO_BUTTONS];
+    static button_mask_type_t currents[256];
+    uint32_t bits[BITS_BTN_COMBO_BITMAP_WORDS];
+    volatile uint32_t scalar_sum = 0;
+    volatile uint32_t bulk_sum = 0;
+
+    for (uint16_t i = 0; i < BITS_BTN_MAX_COMBO_BUTTONS; i++) {
+        masks[i] = random_combo_mask();
+    }
+    for (int i = 0; i < 256; i++) {
+        currents[i] = next_random() | masks[i % BITS_BTN_MAX_COMBO_BUTTONS];
+    }
+
+    clock_t start = clock();
+    for (int round = 0; round < SIMD_BENCH_ROUNDS; round++) {
+        memset(bits, 0, sizeof(bits));
+        __get_combo_pressed_bits_scalar(masks, 0, BITS_BTN_MAX_COMBO_BUTTONS, currents[round & 255], bits);
+        scalar_sum += bits[0];
+    }
+    double scalar_us = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int round = 0; round < SIMD_BENCH_ROUNDS; round++) {
+        __get_combo_pressed_bits(masks, BITS_BTN_MAX_COMBO_BUTTONS, currents[round & 255], bits);
+        bulk_sum += bits[0];
+    }
+    double bulk_us = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC;
+
+    // 两条路径结果一致, 耗时只作记录, 不做断言以免受运行环境影响
+    TEST_ASSERT_EQUAL_HEX32(scalar_sum, bulk_sum);
+    printf("%d个组合键 x %d次: 标量 %.0f us, %s %.0f us, 加速比 %.2fx\n",
+           BITS_BTN_MAX_COMBO_BUTTONS, SIMD_BENCH_ROUNDS, scalar_us, simd_path_name(), bulk_us,
+           bulk_us > 0 ? scalar_us / bulk_us : 0.0);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_combo_simd_matches_scalar);
+    RUN_TEST(test_combo_simd_speedup);
+    return UNITY_END();
+}
@@ -6,6 +6,7 @@
 #include "utils/assert_utils.h"
 #include "config/test_config.h"
 #include "bits_button.h"
+#include <time.h>
 
 // ==================== 测试设置和清理 ====================
 
@@ -148,3 +149,319 @@ void test_memory_usage(void) {
     printf("内存使用测试通过: %d个按键同时工作\n", MAX_TEST_BUTTONS);
 }
 
+
+// ==================== 稀疏活动测试 ====================
+
+void test_sparse_activity_large_population(void) {
+    printf("\n=== 测试大量按键中少数活动 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[MAX_TEST_BUTTONS];
+    uint32_t deadline = 0;
+
+    for (int i = 0; i < MAX_TEST_BUTTONS; i++) {
+        buttons[i] = (button_obj_t)BITS_BUTTON_INIT(i, 1, &param);
+    }
+
+    bits_button_init(buttons, MAX_TEST_BUTTONS, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+
+    // 全部空闲时没有待处理的截止时间, tick 不会分发任何状态机
+    time_simulate_pass(500);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    // 只操作其中两个按键: 一个双击, 一个长按
+    mock_multiple_clicks(3, 2, 80, 120);
+    mock_button_press(12);
+    time_simulate_debounce_delay();
+    time_simulate_long_press_threshold();
+    TEST_ASSERT_TRUE(bits_button_get_next_deadline(&deadline));
+    mock_button_release(12);
+    time_simulate_debounce_delay();
+    time_simulate_time_window_end();
+
+    ASSERT_EVENT_WITH_VALUE(3, BTN_STATE_FINISH, BITS_BTN_DOUBLE_CLICK_KV);
+    ASSERT_EVENT_EXISTS(12, BTN_STATE_LONG_PRESS);
+    ASSERT_EVENT_EXISTS(12, BTN_STATE_FINISH);
+
+    // 其余按键没有任何事件
+    for (int i = 0; i < MAX_TEST_BUTTONS; i++) {
+        if (i == 3 || i == 12) continue;
+        ASSERT_EVENT_NOT_EXISTS(i, BTN_STATE_PRESSED);
+    }
+
+    // 所有状态机回到空闲后, 不再需要 tick
+    time_simulate_pass(100);
+    TEST_ASSERT_FALSE(bits_button_get_next_deadline(&deadline));
+
+    printf("稀疏活动测试通过: %d个按键中仅活动按键被处理\n", MAX_TEST_BUTTONS);
+}
+
+// ==================== 多组合键批量判定测试 ====================
+
+#define BULK_COMBO_CNT  (MAX_TEST_BUTTONS / 2)
+
+void test_many_combos_bulk_evaluation(void) {
+    printf("\n=== 测试多组合键批量判定 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[MAX_TEST_BUTTONS];
+    static uint16_t combo_keys[BULK_COMBO_CNT][2];
+    button_obj_combo_t combos[BULK_COMBO_CNT];
+
+    for (int i = 0; i < MAX_TEST_BUTTONS; i++) {
+        buttons[i] = (button_obj_t)BITS_BUTTON_INIT(i, 1, &param);
+    }
+
+    // 相邻两个按键组成一个组合键, ID为 100 + 序号
+    for (int i = 0; i < BULK_COMBO_CNT; i++) {
+        combo_keys[i][0] = (uint16_t)(2 * i);
+        combo_keys[i][1] = (uint16_t)(2 * i + 1);
+        combos[i] = (button_obj_combo_t)BITS_BUTTON_COMBO_INIT(100 + i, 1, &param, combo_keys[i], 2, 1);
+    }
+
+    TEST_ASSERT_EQUAL(0, bits_button_init(buttons, MAX_TEST_BUTTONS, combos, BULK_COMBO_CNT,
+                                          test_framework_mock_read_button,
+                                          test_framework_event_callback,
+                                          test_framework_log_printf));
+
+    clock_t start = clock();
+    uint32_t ticks_before = bits_button_get_time();
+
+    // 依次单击每个组合键
+    for (int i = 0; i < BULK_COMBO_CNT; i++) {
+        mock_button_press(2 * i);
+        mock_button_press(2 * i + 1);
+        time_simulate_debounce_delay();
+        time_simulate_pass(100);
+        mock_button_release(2 * i);
+        mock_button_release(2 * i + 1);
+        time_simulate_debounce_delay();
+    }
+    time_simulate_time_window_end();
+
+    uint32_t ticks = bits_button_get_time() - ticks_before;
+    double elapsed_us = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC;
+
+    for (int i = 0; i < BULK_COMBO_CNT; i++) {
+        ASSERT_EVENT_WITH_VALUE(100 + i, BTN_STATE_FINISH, BITS_BTN_SINGLE_CLICK_KV);
+        ASSERT_EVENT_NOT_EXISTS(2 * i, BTN_STATE_PRESSED);
+        ASSERT_EVENT_NOT_EXISTS(2 * i + 1, BTN_STATE_PRESSED);
+    }
+
+    printf("多组合键批量判定测试通过: %d个组合键, %u次tick, 平均 %.3f us/tick\n",
+           BULK_COMBO_CNT, (unsigned)ticks, ticks ? elapsed_us / ticks : 0.0);
+}
+
+// ==================== 延迟回调测试 ====================
+
+static uint32_t fake_cycles = 0;
+
+static uint32_t fake_cycle_counter(void) {
+    fake_cycles += 7;
+    return fake_cycles;
+}
+
+void test_deferred_callbacks_tick_cost(void) {
+    printf("\n=== 测试延迟回调与tick开销统计 ===\n");
+
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t button = BITS_BUTTON_INIT(1, 1, &param);
+    bits_btn_tick_stats_t stats;
+
+    bits_button_init(&button, 1, NULL, 0,
+                     test_framework_mock_read_button,
+                     test_framework_event_callback,
+                     test_framework_log_printf);
+    bits_button_set_deferred_callbacks(true);
+    bits_button_set_cycle_counter(fake_cycle_counter);
+    bits_button_reset_tick_stats();
+
+    // tick中只记录事件, 不调用回调
+    mock_button_click(1, STANDARD_CLICK_TIME_MS);
+    time_simulate_time_window_end();
+    TEST_ASSERT_EQUAL(0, test_framework_get_event_count());
+
+    // 线程上下文中处理回调
+    TEST_ASSERT_EQUAL(3, bits_button_process());
+    VERIFY_SINGLE_CLICK(1);
+    TEST_ASSERT_EQUAL(0, bits_button_process());
+
+    TEST_ASSERT_EQUAL(1, bits_button_get_tick_stats(&stats));
+    TEST_ASSERT_TRUE(stats.ticks > 0);
+    TEST_ASSERT_EQUAL_UINT32(7, stats.last_cycles);
+    TEST_ASSERT_EQUAL_UINT32(7, stats.max_cycles);
+    TEST_ASSERT_EQUAL(1, stats.max_events_per_tick);
+    TEST_ASSERT_EQUAL(3, stats.queue_high_water);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped_events);
+
+    // 长时间不处理时队列满, 丢弃的事件被统计
+    for (int i = 0; i < BITS_BTN_EVENT_QUEUE_SIZE; i++) {
+        mock_button_click(1, STANDARD_CLICK_TIME_MS);
+        time_simulate_time_window_end();
+    }
+    TEST_ASSERT_EQUAL(1, bits_button_get_tick_stats(&stats));
+    TEST_ASSERT_EQUAL(BITS_BTN_EVENT_QUEUE_SIZE - 1, stats.queue_high_water);
+    TEST_ASSERT_TRUE(stats.dropped_events > 0);
+    TEST_ASSERT_EQUAL(BITS_BTN_EVENT_QUEUE_SIZE - 1, bits_button_process());
+
+    // 清零请求由下一次tick执行, 之前读到的仍是上次发布的统计
+    bits_button_reset_tick_stats();
+    TEST_ASSERT_EQUAL(1, bits_button_get_tick_stats(&stats));
+    TEST_ASSERT_TRUE(stats.dropped_events > 0);
+    bits_button_ticks();
+    TEST_ASSERT_EQUAL(1, bits_button_get_tick_stats(&stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped_events);
+
+    bits_button_set_deferred_callbacks(false);
+    bits_button_set_cycle_counter(NULL);
+    printf("延迟回调测试通过: 最大tick开销 %u, 丢弃事件 %u\n",
+           (unsigned)stats.max_cycles, (unsigned)stats.dropped_events);
+}
+
+// ==================== 每线程引擎测试 ====================
+
+#ifdef BITS_BTN_THREAD_LOCAL_ENGINE
+#include <pthread.h>
+#include <unistd.h>
+
+#define ENGINE_BUTTONS       BITS_BTN_MAX_KEYS
+#define ENGINE_TICKS         20000
+#define ENGINE_MAX_THREADS   4
+
+typedef struct {
+    uint32_t events;
+} engine_result_t;
+
+static _Thread_local uint32_t engine_events;
+
+// 每个按键按自己的相位周期性单击, 各线程的输入完全相同
+static uint8_t engine_read_button(struct button_obj_t *btn) {
+    return ((bits_button_get_time() / 16) % ENGINE_BUTTONS) == btn->key_id;
+}
+
+static void engine_result_callback(struct button_obj_t *btn, bits_btn_result_t result) {
+    (void)btn;
+    (void)result;
+    engine_events++;
+}
+
+static void *engine_worker(void *arg) {
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_t buttons[ENGINE_BUTTONS];
+    engine_result_t *result = (engine_result_t *)arg;
+
+    for (int i = 0; i < ENGINE_BUTTONS; i++) {
+        buttons[i] = (button_obj_t)BITS_BUTTON_INIT(i, 1, &param);
+    }
+
+    // 每个线程拥有独立的引擎实例
+    engine_events = 0;
+    bits_button_init(buttons, ENGINE_BUTTONS, NULL, 0, engine_read_button, engine_result_callback, NULL);
+    for (int i = 0; i < ENGINE_TICKS; i++) {
+        bits_button_ticks();
+    }
+    result->events = engine_events;
+    return NULL;
+}
+
+static double engine_elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// 在未初始化引擎的线程中调用原本可跨上下文使用的接口
+static void *engine_foreign_caller(void *arg) {
+    static uint16_t combo_keys[] = {0, 1};
+    static const bits_btn_obj_param_t param = TEST_DEFAULT_PARAM();
+    button_obj_combo_t combo = BITS_BUTTON_COMBO_INIT(100, 1, &param, combo_keys, 2, 1);
+    bits_btn_snapshot_t snapshot;
+    int32_t *failures = (int32_t *)arg;
+
+    *failures = 0;
+    if (bits_button_get_snapshot(&snapshot) != 0) (*failures)++;
+    if (bits_button_reset_states() != false) (*failures)++;
+    if (bits_button_process() != 0) (*failures)++;
+    if (bits_button_add_combo(&combo) != -4) (*failures)++;
+    if (bits_button_remove_combo(100) != -4) (*failures)++;
+    if (bits_button_set_param(0, &param) != -4) (*failures)++;
+    if (bits_button_set_key_enabled(0, false) != -4) (*failures)++;
+    return NULL;
+}
+#endif
+
+void test_thread_local_engine_scaling(void) {
+    printf("\n=== 测试每线程引擎扩展性 ===\n");
+
+#ifdef BITS_BTN_THREAD_LOCAL_ENGINE
+    pthread_t threads[ENGINE_MAX_THREADS];
+    engine_result_t results[ENGINE_MAX_THREADS];
+    uint32_t expected_events = 0;
+    double single_thread_ms = 0;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int n = 1; n <= ENGINE_MAX_THREADS; n *= 2) {
+        struct timespec start, end;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, engine_worker, &results[i]));
+        }
+        for (int i = 0; i < n; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        // 各线程的引擎互不干扰, 事件数与单线程运行一致
+        if (n == 1) {
+            expected_events = results[0].events;
+            TEST_ASSERT_TRUE(expected_events > 0);
+        }
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT32(expected_events, results[i].events);
+        }
+
+        double elapsed_ms = engine_elapsed_ms(&start, &end);
+        if (n == 1) {
+            single_thread_ms = elapsed_ms;
+        }
+        double throughput = elapsed_ms > 0 ? n * single_thread_ms / elapsed_ms : (double)n;
+        printf("%d个线程: %d个按键, 每线程%d次tick, 耗时 %.2f ms, 吞吐 %.2fx\n",
+               n, n * ENGINE_BUTTONS, ENGINE_TICKS, elapsed_ms, throughput);
+
+        // 引擎之间没有共享状态, 吞吐应随可用核数扩展; 留一半余量给调度抖动
+        long parallel = (cpus > 0 && cpus < n) ? cpus : n;
+        TEST_ASSERT_TRUE_MESSAGE(throughput >= 0.5 * parallel, "每线程引擎吞吐未随核数扩展");
+    }
+
+    printf("每线程引擎测试通过\n");
+#else
+    TEST_IGNORE_MESSAGE("需要定义 BITS_BTN_THREAD_LOCAL_ENGINE");
+#endif
+}
+
+void test_thread_local_engine_isolation(void) {
+    printf("\n=== 测试每线程引擎的跨线程接口 ===\n");
+
+#ifdef BITS_BTN_THREAD_LOCAL_ENGINE
+    pthread_t thread;
+    int32_t failures = -1;
+    bits_btn_snapshot_t snapshot;
+
+    // 本线程已初始化引擎, 其他线程看到的是自己的空引擎, 调用应被拒绝而不是静默生效
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, engine_foreign_caller, &failures));
+    pthread_join(thread, NULL);
+    TEST_ASSERT_EQUAL(0, failures);
+
+    // 本线程的引擎不受影响
+    bits_button_ticks();
+    TEST_ASSERT_EQUAL(1, bits_button_get_snapshot(&snapshot));
+    TEST_ASSERT_TRUE(bits_button_reset_states());
+
+    printf("跨线程接口拒绝测试通过\n");
+#else
+    TEST_IGNORE_MESSAGE("需要定义 BITS_BTN_THREAD_LOCAL_ENGINE");
+#endif
+}
@@ -78,6 +78,18 @@ else
     TEST_RESULT=$?
 fi
 
+# 每线程引擎配置 (BITS_BTN_THREAD_LOCAL_ENGINE) 重新编译的全部用例, 含多线程扩展性测试
+if [ $TEST_RESULT -eq 0 ] && [ -x ./run_tests_thread_local ]; then
+    echo "🧵 运行每线程引擎测试..."
+    if [ "$CI_MODE" = true ]; then
+        ./run_tests_thread_local 2>&1 | tee -a "../$TEST_LOG"
+        TEST_RESULT=${PIPESTATUS[0]}
+    else
+        ./run_tests_thread_local
+        TEST_RESULT=$?
+    fi
+fi
+
 echo "========================================="
 if [ $TEST_RESULT -eq 0 ]; then
     echo "✅ 所有测试通过！"
@@ -12,8 +12,22 @@ extern void test_double_click_event(void);
 extern void test_triple_click_event(void);
 extern void test_long_press_event(void);
 extern void test_long_press_hold_event(void);
+extern void test_long_press_hold_acceleration(void);
 extern void test_state_reset_functionality(void);
 extern void test_combo_button_reset(void);
+extern void test_change_notification_skips_idle_scan(void);
+extern void test_reset_deferred_to_tick_boundary(void);
+extern void test_reset_drops_deferred_events(void);
+extern void test_runtime_combo_add_remove(void);
+extern void test_runtime_config_queued_changes(void);
+extern void test_runtime_param_swap_and_key_disable(void);
+extern void test_runtime_config_producer_isolation(void);
+extern void test_keymap_momentary_layer(void);
+extern void test_keymap_layer_latched_per_gesture(void);
+extern void test_keymap_follows_runtime_param(void);
+extern void test_priority_key_bypasses_debounce(void);
+extern void test_priority_key_release_debounce(void);
+extern void test_priority_key_rejected_as_member(void);
 
 // 组合按键测试
 extern void test_basic_combo_button(void);
@@ -25,29 +39,49 @@ extern void test_debounce_functionality(void);
 extern void test_very_short_press(void);
 extern void test_long_press_boundary(void);
 extern void test_rapid_clicks_boundary(void);
+extern void test_eager_debounce(void);
 
 // 性能测试
 extern void test_high_frequency_button_presses(void);
 extern void test_multiple_buttons_concurrent(void);
 extern void test_long_running_stability(void);
 extern void test_memory_usage(void);
+extern void test_sparse_activity_large_population(void);
+extern void test_many_combos_bulk_evaluation(void);
+extern void test_deferred_callbacks_tick_cost(void);
+extern void test_thread_local_engine_scaling(void);
+extern void test_thread_local_engine_isolation(void);
 
 // 新增测试函数
 // 缓冲区操作测试
 extern void test_buffer_overflow_protection(void);
 extern void test_buffer_state_tracking(void);
 extern void test_buffer_edge_cases(void);
+extern void test_snapshot_without_consuming_events(void);
+extern void test_result_filter_mask(void);
+extern void test_buffer_view_zero_copy(void);
 
 // 高级组合按键测试
 extern void test_advanced_three_key_combo(void);
 extern void test_combo_with_different_timing(void);
 extern void test_multiple_combos_conflict(void);
+extern void test_combo_term_retracts_member_press(void);
+extern void test_combo_term_releases_solo_press(void);
+extern void test_combo_term_finishes_interrupted_click(void);
+extern void test_batch_callback_combos_first(void);
+extern void test_batch_callback_deferred_mode(void);
+extern void test_key_sequence_match(void);
+extern void test_key_sequence_timeout_and_restart(void);
+extern void test_dual_role_tap_and_hold_time(void);
+extern void test_dual_role_permissive_hold(void);
 
 // 状态机边界测试
 extern void test_state_transition_timing(void);
 extern void test_time_window_boundary(void);
 extern void test_long_press_period_boundary(void);
 extern void test_rapid_state_changes(void);
+extern void test_click_history_overflow(void);
+extern void test_next_deadline_reporting(void);
 
 // 错误处理测试
 extern void test_null_pointer_handling(void);
@@ -61,12 +95,21 @@ extern void test_different_active_levels(void);
 extern void test_custom_parameters(void);
 extern void test_multiple_button_initialization(void);
 extern void test_callback_functions(void);
+extern void test_user_data_and_context(void);
 
 // Peek功能测试
 extern void test_peek_functionality(void);
 extern void test_peek_vs_get_behavior(void);
 extern void test_peek_disabled_buffer_mode(void);
 
+// 外部时间源测试
+extern void test_time_source_irregular_ticks(void);
+extern void test_time_source_lazy_ticks(void);
+extern void test_time_source_release_window(void);
+extern void test_time_source_stale_debounce_deadline(void);
+extern void test_time_source_sample_batch(void);
+extern void test_sample_batch_whole_ticks(void);
+
 // ==================== 测试套件设置函数 ====================
 
 void basic_tests_setup(void) {
@@ -133,8 +176,22 @@ int main(void) {
     RUN_TEST(test_triple_click_event);
     RUN_TEST(test_long_press_event);
     RUN_TEST(test_long_press_hold_event);
+    RUN_TEST(test_long_press_hold_acceleration);
     RUN_TEST(test_state_reset_functionality);
     RUN_TEST(test_combo_button_reset);
+    RUN_TEST(test_change_notification_skips_idle_scan);
+    RUN_TEST(test_reset_deferred_to_tick_boundary);
+    RUN_TEST(test_reset_drops_deferred_events);
+    RUN_TEST(test_runtime_combo_add_remove);
+    RUN_TEST(test_runtime_config_queued_changes);
+    RUN_TEST(test_runtime_param_swap_and_key_disable);
+    RUN_TEST(test_runtime_config_producer_isolation);
+    RUN_TEST(test_keymap_momentary_layer);
+    RUN_TEST(test_keymap_layer_latched_per_gesture);
+    RUN_TEST(test_keymap_follows_runtime_param);
+    RUN_TEST(test_priority_key_bypasses_debounce);
+    RUN_TEST(test_priority_key_release_debounce);
+    RUN_TEST(test_priority_key_rejected_as_member);
 
     printf("\n【组合按键功能测试】\n");
     RUN_TEST(test_basic_combo_button);
@@ -146,28 +203,48 @@ int main(void) {
     RUN_TEST(test_very_short_press);
     RUN_TEST(test_long_press_boundary);
     RUN_TEST(test_rapid_clicks_boundary);
+    RUN_TEST(test_eager_debounce);
 
     printf("\n【性能压力测试】\n");
     RUN_TEST(test_high_frequency_button_presses);
     RUN_TEST(test_multiple_buttons_concurrent);
     RUN_TEST(test_long_running_stability);
     RUN_TEST(test_memory_usage);
+    RUN_TEST(test_sparse_activity_large_population);
+    RUN_TEST(test_many_combos_bulk_evaluation);
+    RUN_TEST(test_deferred_callbacks_tick_cost);
+    RUN_TEST(test_thread_local_engine_scaling);
+    RUN_TEST(test_thread_local_engine_isolation);
 
     printf("\n【缓冲区操作测试】\n");
     RUN_TEST(test_buffer_overflow_protection);
     RUN_TEST(test_buffer_state_tracking);
     RUN_TEST(test_buffer_edge_cases);
+    RUN_TEST(test_snapshot_without_consuming_events);
+    RUN_TEST(test_result_filter_mask);
+    RUN_TEST(test_buffer_view_zero_copy);
 
     printf("\n【高级组合按键测试】\n");
     RUN_TEST(test_advanced_three_key_combo);
     RUN_TEST(test_combo_with_different_timing);
     RUN_TEST(test_multiple_combos_conflict);
+    RUN_TEST(test_combo_term_retracts_member_press);
+    RUN_TEST(test_combo_term_releases_solo_press);
+    RUN_TEST(test_combo_term_finishes_interrupted_click);
+    RUN_TEST(test_batch_callback_combos_first);
+    RUN_TEST(test_batch_callback_deferred_mode);
+    RUN_TEST(test_key_sequence_match);
+    RUN_TEST(test_key_sequence_timeout_and_restart);
+    RUN_TEST(test_dual_role_tap_and_hold_time);
+    RUN_TEST(test_dual_role_permissive_hold);
 
     printf("\n【状态机边界测试】\n");
     RUN_TEST(test_state_transition_timing);
     RUN_TEST(test_time_window_boundary);
     RUN_TEST(test_long_press_period_boundary);
     RUN_TEST(test_rapid_state_changes);
+    RUN_TEST(test_click_history_overflow);
+    RUN_TEST(test_next_deadline_reporting);
 
     printf("\n【错误处理测试】\n");
     RUN_TEST(test_null_pointer_handling);
@@ -181,12 +258,21 @@ int main(void) {
     RUN_TEST(test_custom_parameters);
     RUN_TEST(test_multiple_button_initialization);
     RUN_TEST(test_callback_functions);
+    RUN_TEST(test_user_data_and_context);
 
     printf("\n【Peek功能测试】\n");
     RUN_TEST(test_peek_functionality);
     RUN_TEST(test_peek_vs_get_behavior);
     RUN_TEST(test_peek_disabled_buffer_mode);
 
+    printf("\n【外部时间源测试】\n");
+    RUN_TEST(test_time_source_irregular_ticks);
+    RUN_TEST(test_time_source_lazy_ticks);
+    RUN_TEST(test_time_source_release_window);
+    RUN_TEST(test_time_source_stale_debounce_deadline);
+    RUN_TEST(test_time_source_sample_batch);
+    RUN_TEST(test_sample_batch_whole_ticks);
+
     printf("\n========================================\n");
     printf("           测试完成\n");
     printf("========================================\n");